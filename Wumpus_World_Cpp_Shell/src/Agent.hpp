@@ -9,6 +9,8 @@
 //              parameters to the abstract function 'getAction'. Any
 //              agent will need to implement the getAction function,
 //              which returns an Action for every turn in the game.
+//              Agents are also reset between games, so that one agent
+//              object can play many games without being reallocated.
 //
 // NOTES:       - An agent is anything that can be viewed as perceiving
 //                its environment through sensors and acting upon that
@@ -23,10 +25,14 @@
 #ifndef AGENT_LOCK
 #define AGENT_LOCK
 
+#include <cstdint>
+
 class Agent
 {
 public:
 
+	virtual ~Agent ( ) {}
+
 	// Actuators
 	enum Action
 	{
@@ -48,6 +54,10 @@ public:
 		bool scream
 		
 	) = 0;
+	
+	// Restores the agent to the state of a new game. The seed is
+	// the game's seed, for agents that make random decisions.
+	virtual void reset ( uint64_t seed ) = 0;
 };
 
 #endif
\ No newline at end of file
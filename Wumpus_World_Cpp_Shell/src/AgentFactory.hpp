@@ -0,0 +1,25 @@
+// ======================================================================
+// FILE:        AgentFactory.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the agent factory type, a function
+//              that creates a new agent. Whatever plays many games at
+//              once, the simulator or a batch adapter, takes one to
+//              make as many agents as it needs.
+//
+// NOTES:       - Usage:
+//
+//                  AgentFactory factory = [] () { return new MyAI(); };
+// ======================================================================
+
+#ifndef AGENTFACTORY_LOCK
+#define AGENTFACTORY_LOCK
+
+#include<functional>
+#include"Agent.hpp"
+
+// Creates a new agent, owned by the caller
+typedef std::function<Agent* ( void )> AgentFactory;
+
+#endif /* AGENTFACTORY_LOCK */
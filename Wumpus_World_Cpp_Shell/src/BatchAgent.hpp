@@ -0,0 +1,113 @@
+// ======================================================================
+// FILE:        BatchAgent.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the abstract batch agent class, which
+//              details the interface for an agent that plays many games
+//              at once, and the batch adapter class, which implements it
+//              with one ordinary agent per game. A batch agent takes the
+//              percepts of all its games in one call and returns one
+//              action per game, so it can decide them together instead
+//              of through one virtual call per game and move.
+//
+// NOTES:       - Percepts are one byte of BatchWorld::Percept bits per
+//                game, actions one Agent::Action per game. A game that
+//                is over perceives BatchWorld::GAME_OVER alone, and its
+//                action is ignored.
+//
+//              - A BatchWorld plays a batch agent, see BatchWorld::play.
+//                BatchRandomAI is one that decides its games natively.
+//
+//              - The adapter refuses the ManualAI, which reads every move
+//                from the console and cannot play games side by side.
+//
+//              - Usage of the adapter:
+//
+//                  BatchAdapter agent ( [] () { return new MyAI(); }, 256 );
+//                  BatchWorld batch ( 256 );
+//                  batch.play ( agent, specs, count, scores, seed );
+// ======================================================================
+
+#ifndef BATCHAGENT_LOCK
+#define BATCHAGENT_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <vector>
+#include "Agent.hpp"
+#include "AgentFactory.hpp"
+#include "BatchWorld.hpp"
+#include "ManualAI.hpp"
+
+class BatchAgent
+{
+public:
+
+	virtual ~BatchAgent ( ) {}
+
+	// Writes actions[0..numOfGames), one per game, from the percepts of
+	// every game, percepts[0..numOfGames)
+	virtual void getActions ( size_t numOfGames, const uint8_t *percepts, uint8_t *actions ) = 0;
+
+	// Restores the agent of the game-th game to the state of a new game,
+	// the seed is the agent's, as in Agent::reset
+	virtual void reset ( size_t game, uint64_t seed ) = 0;
+};
+
+class BatchAdapter : public BatchAgent
+{
+public:
+
+	// Creates one agent per game, numOfGames of them, throws
+	// std::exception if the factory makes a ManualAI
+	BatchAdapter ( const AgentFactory &factory, size_t numOfGames )
+	{
+		for ( size_t game = 0; game < numOfGames; ++game )
+		{
+			agents.emplace_back ( factory() );
+			if ( dynamic_cast<ManualAI*> ( agents.back().get() ) )
+				throw std::exception();
+		}
+	}
+
+	// Asks every game's agent, throws std::exception if there are more
+	// games than agents
+	void getActions ( size_t numOfGames, const uint8_t *percepts, uint8_t *actions )
+	{
+		if ( numOfGames > agents.size() )
+			throw std::exception();
+
+		for ( size_t game = 0; game < numOfGames; ++game )
+		{
+			uint8_t percept = percepts[game];
+			if ( percept & BatchWorld::GAME_OVER )
+			{
+				actions[game] = Agent::CLIMB;
+				continue;
+			}
+
+			actions[game] = agents[game]->getAction
+			(
+				percept & BatchWorld::STENCH,
+				percept & BatchWorld::BREEZE,
+				percept & BatchWorld::GLITTER,
+				percept & BatchWorld::BUMP,
+				percept & BatchWorld::SCREAM
+			);
+		}
+	}
+
+	void reset ( size_t game, uint64_t seed )
+	{
+		agents.at ( game )->reset ( seed );
+	}
+
+private:
+
+	std::vector<std::unique_ptr<Agent>>	agents;		// One agent per game
+};
+
+#endif /* BATCHAGENT_LOCK */
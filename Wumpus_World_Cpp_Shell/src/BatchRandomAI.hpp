@@ -0,0 +1,83 @@
+// ======================================================================
+// FILE:        BatchRandomAI.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the batch random agent class, the
+//              RandomAI of every game of a batch in one object. It keeps
+//              one generator per game in an array, and takes the actions
+//              of all its games in one loop, with no virtual call and no
+//              agent object per game.
+//
+// NOTES:       - Game for game, it plays the moves of a RandomAI reset
+//                with the same seed, so a BatchWorld scores its games as
+//                a World scores the RandomAI's.
+//
+//              - Usage:
+//
+//                  BatchRandomAI agent ( 64 );
+//                  BatchWorld batch ( 64 );
+//                  batch.play ( agent, specs, count, scores, seed );
+// ======================================================================
+
+#ifndef BATCHRANDOMAI_LOCK
+#define BATCHRANDOMAI_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include "Agent.hpp"
+#include "BatchAgent.hpp"
+#include "BatchWorld.hpp"
+#include "Random.hpp"
+
+class BatchRandomAI : public BatchAgent
+{
+public:
+
+	// Holds the generators of numOfGames games
+	BatchRandomAI ( size_t numOfGames ) : rngs ( numOfGames ) {}
+
+	// Grabs on glitter and draws a move otherwise, as RandomAI does,
+	// throws std::exception if there are more games than generators
+	void getActions ( size_t numOfGames, const uint8_t *percepts, uint8_t *actions )
+	{
+		if ( numOfGames > rngs.size() )
+			throw std::exception();
+
+		// RandomAI's moves, in the order it draws them
+		static const uint8_t moves[6] =
+		{
+			Agent::TURN_LEFT,
+			Agent::TURN_RIGHT,
+			Agent::FORWARD,
+			Agent::SHOOT,
+			Agent::GRAB,
+			Agent::CLIMB
+		};
+
+		Random *rng = rngs.data();
+		for ( size_t game = 0; game < numOfGames; ++game )
+		{
+			uint8_t percept = percepts[game];
+			if ( percept & BatchWorld::GAME_OVER )
+				actions[game] = Agent::CLIMB;
+			else if ( percept & BatchWorld::GLITTER )
+				actions[game] = Agent::GRAB;
+			else
+				actions[game] = moves [ rng[game].randomInt ( 6 ) ];
+		}
+	}
+
+	void reset ( size_t game, uint64_t seed )
+	{
+		rngs.at ( game ) = Random ( seed );
+	}
+
+private:
+
+	std::vector<Random>	rngs;		// One generator per game
+};
+
+#endif /* BATCHRANDOMAI_LOCK */
@@ -0,0 +1,432 @@
+// ======================================================================
+// FILE:        BatchWorld.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the batch world class, an engine that
+//              plays many games in lockstep.
+//
+// NOTES:       - A step is one pass over the games, the same arithmetic
+//                for each: every action's outcome is worked out as a
+//                mask of all ones or all zeros per game and only kept
+//                where the game plays that action, so no branch depends
+//                on a game. The pass is written once, over a lane type
+//                that holds one game or four, so the AVX2 path and the
+//                plain one cannot drift apart.
+// ======================================================================
+
+#include "BatchWorld.hpp"
+#include "BatchAgent.hpp"
+#include "Random.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+
+using namespace std;
+
+static const uint64_t	FIRST_COLUMN = 0x0101010101010101ULL;
+static const uint64_t	LAST_COLUMN  = FIRST_COLUMN << 7;
+
+// The tiles next to the given ones, off the board or not
+static uint64_t neighbors ( uint64_t tiles )
+{
+	return ( ( tiles << 1 ) & ~FIRST_COLUMN ) | ( ( tiles >> 1 ) & ~LAST_COLUMN ) | tiles << 8 | tiles >> 8;
+}
+
+// ===============================================================
+// =					Lanes
+// ===============================================================
+
+// A lane type holds one game or four, as a vector of GCC's vector
+// extension, which has the same operators lane by lane, and where a
+// comparison gives all ones in the lanes where it holds
+typedef uint64_t	Lanes1			__attribute__ (( vector_size ( 8 ) ));
+typedef int64_t		SignedLanes1	__attribute__ (( vector_size ( 8 ) ));
+typedef int8_t		Bytes1			__attribute__ (( vector_size ( 8 ) ));
+
+#if defined ( __x86_64__ )
+#define BATCHWORLD_AVX2
+typedef uint64_t	Lanes4			__attribute__ (( vector_size ( 32 ) ));
+typedef int64_t		SignedLanes4	__attribute__ (( vector_size ( 32 ) ));
+typedef int8_t		Bytes4			__attribute__ (( vector_size ( 32 ) ));
+#endif
+
+// The signed lanes of the same width, for the scores
+template <typename Lanes> struct Signed;
+template <> struct Signed<Lanes1> { typedef SignedLanes1 type; };
+
+// The actions of the games, one byte each, widened to the lanes
+static inline void widen ( const uint8_t *bytes, Lanes1 &lanes )
+{
+	lanes = (Lanes1){ bytes[0] };
+}
+
+// The low byte of each lane, written one byte per game
+static inline void narrow ( const Lanes1 &lanes, uint8_t *bytes )
+{
+	bytes[0] = (uint8_t)lanes[0];
+}
+
+// The row of each lane's tile, the byte it is in, all ones
+static inline void rowOf ( const Lanes1 &tile, Lanes1 &row )
+{
+	row = (Lanes1)( (Bytes1)tile != 0 );
+}
+
+// The column of each lane's tile, the low byte of tiles copied to
+// every byte
+static inline void columnOf ( const Lanes1 &tiles, Lanes1 &column )
+{
+	column = (Lanes1)__builtin_shuffle ( (Bytes1)tiles, (Bytes1){ 0, 0, 0, 0, 0, 0, 0, 0 } );
+}
+
+// The sum of the lanes
+static inline uint64_t sumOf ( const Lanes1 &lanes )
+{
+	return lanes[0];
+}
+
+#ifdef BATCHWORLD_AVX2
+template <> struct Signed<Lanes4> { typedef SignedLanes4 type; };
+
+static inline void widen ( const uint8_t *bytes, Lanes4 &lanes )
+{
+	lanes = (Lanes4){ bytes[0], bytes[1], bytes[2], bytes[3] };
+}
+
+// The low bytes are shifted to the byte of their game, then gathered
+static inline void narrow ( const Lanes4 &lanes, uint8_t *bytes )
+{
+	Lanes4 shifted = ( lanes & 0xFF ) << (Lanes4){ 0, 8, 16, 24 };
+	uint32_t packed = shifted[0] | shifted[1] | shifted[2] | shifted[3];
+	memcpy ( bytes, &packed, sizeof packed );
+}
+
+static inline void rowOf ( const Lanes4 &tile, Lanes4 &row )
+{
+	row = (Lanes4)( (Bytes4)tile != 0 );
+}
+
+static inline void columnOf ( const Lanes4 &tiles, Lanes4 &column )
+{
+	column = (Lanes4)__builtin_shuffle ( (Bytes4)tiles, (Bytes4){ 0, 0, 0, 0, 0, 0, 0, 0, 8, 8, 8, 8, 8, 8, 8, 8,
+	                                                              16, 16, 16, 16, 16, 16, 16, 16, 24, 24, 24, 24, 24, 24, 24, 24 } );
+}
+
+static inline uint64_t sumOf ( const Lanes4 &lanes )
+{
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+#endif
+
+// ===============================================================
+// =					Constructor and Size
+// ===============================================================
+
+#ifdef BATCHWORLD_AVX2
+bool BatchWorld::hasAvx2 = __builtin_cpu_supports ( "avx2" );
+#else
+bool BatchWorld::hasAvx2 = false;
+#endif
+
+BatchWorld::BatchWorld ( size_t numOfGames )
+{
+	resize ( numOfGames );
+}
+
+void BatchWorld::resize ( size_t numOfGames )
+{
+	board.assign ( numOfGames, 1 );
+	pits.assign ( numOfGames, 0 );
+	wumpus.assign ( numOfGames, 0 );
+	gold.assign ( numOfGames, 0 );
+	breeze.assign ( numOfGames, 0 );
+	stench.assign ( numOfGames, 0 );
+
+	agentAt.assign ( numOfGames, 1 );
+	agentDir.assign ( numOfGames, 0 );
+	score.assign ( numOfGames, 0 );
+	flags.assign ( numOfGames, OVER );
+	percept.assign ( numOfGames, GAME_OVER );
+
+	action.assign ( numOfGames, Agent::CLIMB );
+	specOf.assign ( numOfGames, 0 );
+
+	numOfLive = 0;
+}
+
+// ===============================================================
+// =					Game Initialization
+// ===============================================================
+
+bool BatchWorld::fits ( const WorldSpec &spec )
+{
+	return spec.colDimension >= 1 && spec.colDimension <= MAX_DIMENSION
+		&& spec.rowDimension >= 1 && spec.rowDimension <= MAX_DIMENSION;
+}
+
+void BatchWorld::reset ( size_t game, const WorldSpec &spec )
+{
+	if ( !fits ( spec ) )
+		throw exception();
+
+	int c = spec.colDimension;
+	int r = spec.rowDimension;
+
+	// Features outside the board are ignored, as by the Rules
+	auto bit = [c, r] ( int tileC, int tileR ) -> uint64_t
+	{
+		if ( tileC < 0 || tileC >= c || tileR < 0 || tileR >= r )
+			return 0;
+		return 1ULL << ( tileR*8 + tileC );
+	};
+
+	uint64_t pitTiles = 0;
+	for ( size_t index = 0; index < spec.pits.size(); ++index )
+		pitTiles |= bit ( spec.pits[index].first, spec.pits[index].second );
+
+	start ( game, c, r, pitTiles, bit ( spec.wumpusC, spec.wumpusR ), bit ( spec.goldC, spec.goldR ) );
+}
+
+void BatchWorld::reset ( size_t game, const uint8_t *record )
+{
+	uint64_t pitTiles = 0;
+	for ( int index = 7; index >= 0; --index )
+		pitTiles = pitTiles << 8 | record[8+index];
+
+	start ( game, record[0], record[1], pitTiles, 1ULL << ( record[3]*8 + record[2] ), 1ULL << ( record[5]*8 + record[4] ) );
+}
+
+void BatchWorld::start ( size_t game, int c, int r, uint64_t pitTiles, uint64_t wumpusTile, uint64_t goldTile )
+{
+	// The first c tiles of each of the first r rows
+	uint64_t boardTiles = ( ( 1ULL << c ) - 1 ) * ( FIRST_COLUMN >> ( 64 - 8*r ) );
+
+	board[game]  = boardTiles;
+	pits[game]   = pitTiles;
+	wumpus[game] = wumpusTile;
+	gold[game]   = goldTile;
+	breeze[game] = neighbors ( pitTiles ) & boardTiles;
+	stench[game] = neighbors ( wumpusTile ) & boardTiles;
+
+	numOfLive += ( flags[game] & OVER ) != 0;
+	agentAt[game]  = 1;
+	agentDir[game] = 0;
+	score[game]    = 0;
+	flags[game]    = ARROW;
+
+	percept[game] = ( stench[game] & 1 ? STENCH : 0 ) | ( breeze[game] & 1 ? BREEZE : 0 ) | ( goldTile & 1 ? GLITTER : 0 );
+}
+
+// ===============================================================
+// =					Engine Functions
+// ===============================================================
+
+// The lanes are loaded and stored with memcpy, which compiles to plain
+// unaligned loads and stores of the whole vector
+template <typename Lanes>
+__attribute__ (( always_inline )) inline
+size_t BatchWorld::stepLanes ( size_t first, size_t last, const uint8_t *actions )
+{
+	typedef typename Signed<Lanes>::type SignedLanes;
+	const size_t width = sizeof ( Lanes ) / sizeof ( uint64_t );
+
+	// The arrays, through local pointers so that the stores cannot make
+	// the compiler reload their addresses
+	const uint64_t	*boardOf   = board.data();
+	const uint64_t	*pitsOf    = pits.data();
+	const uint64_t	*breezeOf  = breeze.data();
+	uint64_t		*wumpusOf  = wumpus.data();
+	uint64_t		*goldOf    = gold.data();
+	uint64_t		*stenchOf  = stench.data();
+	uint64_t		*atOf      = agentAt.data();
+	uint64_t		*dirOf     = agentDir.data();
+	int64_t			*scoreOf   = score.data();
+	uint64_t		*flagsOf   = flags.data();
+	uint8_t			*perceptOf = percept.data();
+
+	Lanes numOfEnded = {};
+	for ( size_t game = first; game + width <= last; game += width )
+	{
+		// Games that are all over are passed over whole, a branch per
+		// lane type, not per game
+		uint64_t allOver = OVER;
+		for ( size_t lane = 0; lane < width; ++lane )
+			allOver &= flagsOf[game+lane];
+		if ( allOver )
+			continue;
+
+		Lanes flag;
+		memcpy ( &flag, flagsOf + game, sizeof flag );
+		Lanes live = (Lanes)( ( flag & (uint64_t)OVER ) == 0 );
+
+		Lanes tiles, pitTiles, wumpusTile, goldTile, stenchTiles, at, dir, action;
+		SignedLanes s;
+		memcpy ( &tiles, boardOf + game, sizeof tiles );
+		memcpy ( &pitTiles, pitsOf + game, sizeof pitTiles );
+		memcpy ( &wumpusTile, wumpusOf + game, sizeof wumpusTile );
+		memcpy ( &goldTile, goldOf + game, sizeof goldTile );
+		memcpy ( &stenchTiles, stenchOf + game, sizeof stenchTiles );
+		memcpy ( &at, atOf + game, sizeof at );
+		memcpy ( &dir, dirOf + game, sizeof dir );
+		memcpy ( &s, scoreOf + game, sizeof s );
+		widen ( actions + game, action );
+
+		// All ones in the games that are not over and play the action,
+		// a game that is over plays no action
+		action |= ~live;
+		Lanes left    = (Lanes)( action == (uint64_t)Agent::TURN_LEFT );
+		Lanes right   = (Lanes)( action == (uint64_t)Agent::TURN_RIGHT );
+		Lanes forward = (Lanes)( action == (uint64_t)Agent::FORWARD );
+		Lanes shoot   = (Lanes)( action == (uint64_t)Agent::SHOOT );
+		Lanes grab    = (Lanes)( action == (uint64_t)Agent::GRAB );
+		Lanes climb   = (Lanes)( action == (uint64_t)Agent::CLIMB );
+
+		// A mask of all ones is -1, an action costs one point
+		s += (SignedLanes)live;
+
+		// Turning, a left turn is three right turns
+		dir = ( dir + left - right ) & 3;
+		Lanes east  = (Lanes)( dir == 0 );
+		Lanes south = (Lanes)( dir == 1 );
+		Lanes west  = (Lanes)( dir == 2 );
+		Lanes north = (Lanes)( dir == 3 );
+
+		// Moving, the tile ahead must be on the board
+		Lanes ahead = ( east & ( at << 1 ) & ~FIRST_COLUMN )
+		            | ( south & ( at >> 8 ) )
+		            | ( west & ( at >> 1 ) & ~LAST_COLUMN )
+		            | ( north & ( at << 8 ) );
+		ahead &= tiles;
+		Lanes moved  = forward & ~(Lanes)( ahead == 0 );
+		Lanes bumped = forward & ~moved;
+		at = ( ahead & moved ) | ( at & ~moved );
+		Lanes died = forward & ~(Lanes)( ( ( pitTiles | wumpusTile ) & at ) == 0 );
+		s -= (SignedLanes)( died & 1000 );
+
+		// Shooting, the arrow flies from the agent's tile to the edge,
+		// and a pit under the wumpus stays deadly after the hit. It flies
+		// over the tiles of the agent's row or column, east and north
+		// those from the agent's bit up, -at, west and south those from
+		// its bit down. The column is the byte of the agent's bit, found
+		// by folding the bytes onto the low one, copied to every byte
+		Lanes fired = shoot & ~(Lanes)( ( flag & (uint64_t)ARROW ) == 0 );
+		s -= (SignedLanes)( fired & 10 );
+		Lanes row, column, fold = at | at >> 32;
+		fold |= fold >> 16;
+		fold |= fold >> 8;
+		rowOf ( at, row );
+		columnOf ( fold, column );
+		Lanes above = -at, below = at | ( at - 1 );
+		Lanes down = west | south, across = east | west;
+		Lanes hit = wumpusTile & fired & ( ( down & below ) | ( ~down & above ) )
+		                              & ( ( across & row ) | ( ~across & column ) );
+		wumpusTile  &= ~hit;
+		stenchTiles |= hit;
+		flag        &= ~( shoot & (uint64_t)ARROW );
+		Lanes screamed = ~(Lanes)( hit == 0 );
+
+		// Grabbing
+		Lanes grabbed = grab & ~(Lanes)( ( goldTile & at ) == 0 );
+		goldTile &= ~( grabbed & at );
+		flag     |= grabbed & (uint64_t)LOOTED;
+
+		// Climbing, with the gold or not
+		Lanes climbed = climb & (Lanes)( at == 1 );
+		Lanes looted  = ~(Lanes)( ( flag & (uint64_t)LOOTED ) == 0 );
+		s += (SignedLanes)( climbed & looted & 1000 );
+
+		Lanes ended = live & ( died | climbed | (Lanes)( s < -1000 ) );
+		flag |= ended & (uint64_t)OVER;
+		numOfEnded -= ended;
+
+		// The percepts after the step, GAME_OVER alone once over
+		Lanes breezeTiles;
+		memcpy ( &breezeTiles, breezeOf + game, sizeof breezeTiles );
+		Lanes sensed = ( ~(Lanes)( ( stenchTiles & at ) == 0 ) & (uint64_t)STENCH )
+		             | ( ~(Lanes)( ( breezeTiles & at ) == 0 ) & (uint64_t)BREEZE )
+		             | ( ~(Lanes)( ( goldTile & at ) == 0 ) & (uint64_t)GLITTER )
+		             | ( bumped & (uint64_t)BUMP ) | ( screamed & (uint64_t)SCREAM );
+		Lanes over = ended | ~live;
+		sensed = ( over & (uint64_t)GAME_OVER ) | ( ~over & sensed );
+
+		memcpy ( wumpusOf + game, &wumpusTile, sizeof wumpusTile );
+		memcpy ( goldOf + game, &goldTile, sizeof goldTile );
+		memcpy ( stenchOf + game, &stenchTiles, sizeof stenchTiles );
+		memcpy ( atOf + game, &at, sizeof at );
+		memcpy ( dirOf + game, &dir, sizeof dir );
+		memcpy ( scoreOf + game, &s, sizeof s );
+		memcpy ( flagsOf + game, &flag, sizeof flag );
+		narrow ( sensed, perceptOf + game );
+	}
+	return sumOf ( numOfEnded );
+}
+
+#ifdef BATCHWORLD_AVX2
+__attribute__ (( target ( "avx2" ) ))
+size_t BatchWorld::stepAvx2 ( const uint8_t *actions )
+{
+	size_t numOfGames = size();
+	size_t numOfWide  = numOfGames - numOfGames % 4;
+	return stepLanes<Lanes4> ( 0, numOfWide, actions ) + stepLanes<Lanes1> ( numOfWide, numOfGames, actions );
+}
+#else
+size_t BatchWorld::stepAvx2 ( const uint8_t *actions )
+{
+	return stepLanes<Lanes1> ( 0, size(), actions );
+}
+#endif
+
+void BatchWorld::step ( const uint8_t *actions )
+{
+	numOfLive -= hasAvx2 ? stepAvx2 ( actions ) : stepLanes<Lanes1> ( 0, size(), actions );
+}
+
+void BatchWorld::getPercepts ( uint8_t *percepts ) const
+{
+	memcpy ( percepts, percept.data(), size() );
+}
+
+// ===============================================================
+// =					Play Function
+// ===============================================================
+
+void BatchWorld::play ( BatchAgent &agent, const WorldSpec *specs, size_t count, int *scores, uint64_t seed )
+{
+	size_t numOfGames = size();
+	if ( numOfGames == 0 && count > 0 )
+		throw exception();
+
+	// Ends every game still running, before any spec starts
+	resize ( numOfGames );
+
+	fill ( specOf.begin(), specOf.end(), count );
+	size_t nextSpec = 0;
+
+	while ( true )
+	{
+		for ( size_t game = 0; game < numOfGames; ++game )
+		{
+			if ( !isOver ( game ) )
+				continue;
+
+			if ( specOf[game] < count )
+				scores[specOf[game]] = score[game];
+			specOf[game] = count;
+
+			if ( nextSpec < count )
+			{
+				reset ( game, specs[nextSpec] );
+				agent.reset ( game, Random::deriveSeed ( seed+nextSpec, 1 ) );
+				specOf[game] = nextSpec++;
+			}
+		}
+		if ( numOfLive == 0 )
+			break;
+
+		// step leaves the percepts in percept, no copy needed
+		agent.getActions ( numOfGames, percept.data(), action.data() );
+		step ( action.data() );
+	}
+}
@@ -0,0 +1,143 @@
+// ======================================================================
+// FILE:        BatchWorld.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the batch world class, an engine that
+//              plays many games in lockstep. Every step takes one action
+//              per game and applies them all in one pass. The games are
+//              stored as a structure of arrays, one array of 64-bit lanes
+//              per variable with one entry per game, and each board is a
+//              handful of 64-bit masks, the agent's tile one of them, so
+//              a step is the same mask arithmetic for every game, with
+//              no branch and no table lookup, several games at a time
+//              where the machine has the vector instructions for it.
+//
+// NOTES:       - The games follow the Rules exactly, a game played here
+//                scores what it scores in a World.
+//
+//              - Boards are at most 8x8, tile (c, r) is bit r*8+c of a
+//                mask, as in a corpus record.
+//
+//              - A game is over once it ended by the Rules or its score
+//                fell below -1000, as World::run ends it. The actions
+//                given to a game that is over are ignored.
+//
+//              - On x86-64 built with GCC, step takes 4 games at a time
+//                with AVX2 when the processor has it, and one at a time
+//                otherwise. It works out the percepts of the games that
+//                it leaves, so getPercepts only copies them.
+// ======================================================================
+
+#ifndef BATCHWORLD_LOCK
+#define BATCHWORLD_LOCK
+
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+#include"Agent.hpp"
+#include"WorldSpec.hpp"
+
+class BatchAgent;
+
+class BatchWorld
+{
+public:
+
+	static const int	MAX_DIMENSION = 8;	// Largest board a game can have
+
+	// Percept bits, one byte of them per game
+	enum Percept
+	{
+		STENCH  = 1 << 0,
+		BREEZE  = 1 << 1,
+		GLITTER = 1 << 2,
+		BUMP    = 1 << 3,
+		SCREAM  = 1 << 4,
+
+		GAME_OVER = 1 << 5	// Alone, for a game that is over
+	};
+
+	// Constructor, every game is over until it is reset
+	BatchWorld ( size_t numOfGames = 0 );
+
+	// Holds numOfGames games, every one over until it is reset
+	void	resize	( size_t numOfGames );
+	size_t	size	( void ) const { return score.size(); }
+
+	// True if spec fits on a board of at most 8x8
+	static bool	fits	( const WorldSpec &spec );
+
+	// Starts the game-th game on spec, throws std::exception if it does not fit
+	void	reset	( size_t game, const WorldSpec &spec );
+
+	// Starts the game-th game on a corpus record, Corpus::RECORD_SIZE bytes
+	// of a valid world as Corpus::encode writes them, without the checks
+	void	reset	( size_t game, const uint8_t *record );
+
+	// Makes one move in every game, actions holds one Agent::Action per game
+	void	step	( const uint8_t *actions );
+
+	// Writes the percepts of every game, one byte of Percept bits each
+	void	getPercepts	( uint8_t *percepts ) const;
+
+	// Plays specs[0..count) with agent, writing the scores to
+	// scores[0..count). The games stream through all size() games of
+	// the batch, specs[i] starting with seed+i as soon as one is over,
+	// its agent reset as World::reset resets an agent for seed+i.
+	// Throws std::exception if the batch holds no game or a spec does
+	// not fit.
+	void	play	( BatchAgent &agent, const WorldSpec *specs, size_t count, int *scores, uint64_t seed = 0 );
+
+	// Results
+	int		getScore	( size_t game ) const { return score[game]; }
+	bool	isOver		( size_t game ) const { return flags[game] & OVER; }
+	size_t	getNumOfLive	( void ) const { return numOfLive; }
+
+private:
+
+	// Flag bits of a game
+	enum Flag
+	{
+		LOOTED = 1 << 0,
+		ARROW  = 1 << 1,
+		OVER   = 1 << 2
+	};
+
+	// Board Variables, the masks of each game's board
+	std::vector<uint64_t>	board;		// The tiles on the board
+	std::vector<uint64_t>	pits;
+	std::vector<uint64_t>	wumpus;		// The live wumpus
+	std::vector<uint64_t>	gold;
+	std::vector<uint64_t>	breeze;
+	std::vector<uint64_t>	stench;
+
+	// Agent Variables, 64 bits each, so every array has the same lanes
+	std::vector<uint64_t>	agentAt;	// The agent's tile, as a mask
+	std::vector<uint64_t>	agentDir;	// 0 - right, 1 - down, 2 - left, 3 - up
+	std::vector<int64_t>	score;
+	std::vector<uint64_t>	flags;		// Flag bits
+	std::vector<uint8_t>	percept;	// Percept bits, as of the last step
+
+	// Play Variables, kept so play allocates nothing once the batch is sized
+	std::vector<uint8_t>	action;		// The action each game takes next
+	std::vector<size_t>		specOf;		// The spec each game plays, count if none
+
+	size_t	numOfLive;	// Games not over
+
+	// Starts the game-th game on a board of c columns and r rows
+	void	start	( size_t game, int c, int r, uint64_t pitTiles, uint64_t wumpusTile, uint64_t goldTile );
+
+	// True if step can use AVX2
+	static bool	hasAvx2;
+
+	// One step of the games first, first+1, ... before last, as many at a
+	// time as Lanes holds, returning the number of games it ended
+	template <typename Lanes>
+	size_t	stepLanes		( size_t first, size_t last, const uint8_t *actions );
+
+	// step with AVX2
+	size_t	stepAvx2		( const uint8_t *actions );
+};
+
+#endif /* BATCHWORLD_LOCK */
@@ -0,0 +1,987 @@
+// ======================================================================
+// FILE:        Benchmark.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file is the entry point for the benchmark program.
+//              It measures the latency of the agents on random square
+//              worlds of every size from 4x4 to 8x8:
+//
+//              - getAction, the time of every single decision, taken by
+//                wrapping the agent in a timing agent.
+//
+//              - run, the time of a whole game, agent and engine
+//                together, without the timing agent.
+//
+//              With -l it measures how the engine and MyAI scale instead,
+//              on random square worlds from 4x4 up to 1024x1024, doubling
+//              the size each time. For every size it reports the mean
+//              per game of:
+//
+//              - the actions taken,
+//
+//              - reset, the engine setting up the board,
+//
+//              - engine, World::run without the agent's decisions,
+//
+//              - agent, the agent's reset and decisions,
+//
+//              along with actions per second for the engine and the
+//              agent, and the peak resident memory of the process so far.
+//
+//              With -e it measures the engines instead, on random
+//              square worlds from 4x4 to 8x8. MyAI's and RandomAI's games
+//              are recorded as traces first, then their actions are
+//              played again by:
+//
+//              - rules, one game after the other through Rules::step on
+//                a GameState,
+//
+//              - fixed, the same on the FixedState of the board's size,
+//                as World::run plays outside debug mode,
+//
+//              - batch, 64 games at a time in lockstep in a BatchWorld,
+//                a game starting as soon as another is over,
+//
+//              both reading every percept, as an agent would. Then each
+//              agent plays its games again, with the same seeds:
+//
+//              - world, one game after the other in a World,
+//
+//              - lockstep, 256 games at a time in a BatchWorld, through
+//                a BatchAdapter holding one agent per game,
+//
+//              - native, for RandomAI, the same through a BatchRandomAI
+//                deciding all its games in one call,
+//
+//              - simulator, through Simulator::simulateBatch on one
+//                thread, after a first batch of the same games.
+//
+//              RandomAI draws its moves from its seed, so its rows also
+//              check that every path seeds the agent as the World does.
+//
+//              It reports the time per game-step, for the engines the
+//              fastest of 5 passes, the calls to operator new per game,
+//              and checks that every game reaches its recorded score.
+//
+// NOTES:       - Syntax:
+//
+//                	Wumpus_World_Bench [Options]
+//
+//                  Options:
+//                      -gN plays N measured games per agent and size.
+//                          The default is 2000, 20 with -l, or 10000
+//                          with -e.
+//                      -wN plays N warmup games per agent and size
+//                          before measuring. The default is 200, or 2
+//                          with -l.
+//                      -l  measures scaling on large boards.
+//                      -e  measures the engines, and the agents in them
+//                          and in the Simulator.
+//                      -mN stops -l at boards of N x N. The default is
+//                          1024.
+//                      -sN seeds the worlds with N. The default is 1,
+//                          so two runs measure the same games.
+//                      -c  prints CSV instead of a table.
+//                      -o  prints JSON instead of a table.
+//                      -h  Displays help menu and quits.
+//
+//              - Times are in nanoseconds. Every getAction sample
+//                includes one clock read, whose cost is printed as
+//                clock overhead. With -l that read is counted in the
+//                engine's time instead.
+//
+//              - Peak memory is the maximum resident set size reported
+//                by getrusage, in KiB. Sizes run in increasing order, so
+//                it grows with the largest board played so far.
+//
+//              - The benchmark replaces the global operator new with one
+//                that counts its calls, for the allocations of -e.
+// ======================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include "BatchAgent.hpp"
+#include "BatchRandomAI.hpp"
+#include "BatchWorld.hpp"
+#include "Corpus.hpp"
+#include "FixedState.hpp"
+#include "Simulator.hpp"
+#include "Trace.hpp"
+#include "World.hpp"
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+// ===============================================================
+// =						Allocation Count
+// ===============================================================
+
+static atomic<uint64_t>	numOfNews ( 0 );	// Calls to operator new so far
+
+// The replacements allocate with malloc and free with free, in every form
+// the standard library uses. They are kept out of line, so the compiler
+// never pairs an inlined free with the standard operator new
+__attribute__((noinline)) void* operator new ( size_t size )
+{
+	++numOfNews;
+	void *memory = malloc ( size > 0 ? size : 1 );
+	if ( !memory )
+		throw bad_alloc();
+	return memory;
+}
+
+__attribute__((noinline)) void* operator new[] ( size_t size )
+{
+	return operator new ( size );
+}
+
+__attribute__((noinline)) void operator delete ( void *memory ) noexcept
+{
+	free ( memory );
+}
+
+__attribute__((noinline)) void operator delete[] ( void *memory ) noexcept
+{
+	operator delete ( memory );
+}
+
+// ===============================================================
+// =						Timing Agent
+// ===============================================================
+
+// Forwards every call to the agent it wraps, recording how long each
+// getAction takes
+class TimingAgent : public Agent
+{
+public:
+
+	TimingAgent ( Agent *_agent, vector<uint64_t> &_samples ) : agent ( _agent ), samples ( _samples ), resetTime ( 0 ) {}
+
+	Action getAction
+	(
+		bool stench,
+		bool breeze,
+		bool glitter,
+		bool bump,
+		bool scream
+	)
+	{
+		Clock::time_point start = Clock::now();
+		Action action = agent->getAction ( stench, breeze, glitter, bump, scream );
+		Clock::time_point end = Clock::now();
+
+		samples.push_back ( chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+		return action;
+	}
+
+	void reset ( uint64_t seed )
+	{
+		Clock::time_point start = Clock::now();
+		agent->reset ( seed );
+		Clock::time_point end = Clock::now();
+
+		resetTime = chrono::duration_cast<chrono::nanoseconds> ( end - start ).count();
+	}
+
+	// Time of the latest reset
+	uint64_t lastResetTime ( void ) const { return resetTime; }
+
+private:
+
+	Agent				*agent;		// The agent being timed, not owned
+	vector<uint64_t>	&samples;	// Where the times are recorded
+	uint64_t			resetTime;	// Time of the latest reset
+};
+
+// ===============================================================
+// =						Statistics
+// ===============================================================
+
+struct Result
+{
+	string		agent;
+	string		metric;
+	int			size;
+	string		unit;
+	size_t		count;
+	double		mean;
+	uint64_t	p50;
+	uint64_t	p90;
+	uint64_t	p99;
+	uint64_t	max;
+};
+
+Result summarize ( const string &agent, const string &metric, int size, const string &unit, vector<uint64_t> &samples )
+{
+	Result result = { agent, metric, size, unit, samples.size(), 0, 0, 0, 0, 0 };
+	if ( samples.empty() )
+		return result;
+
+	sort ( samples.begin(), samples.end() );
+
+	double sum = 0;
+	for ( uint64_t sample : samples )
+		sum += sample;
+
+	result.mean = sum / samples.size();
+	result.p50  = samples[( samples.size()-1 ) * 50 / 100];
+	result.p90  = samples[( samples.size()-1 ) * 90 / 100];
+	result.p99  = samples[( samples.size()-1 ) * 99 / 100];
+	result.max  = samples.back();
+	return result;
+}
+
+// Cost of one clock read, the median of many back to back reads
+uint64_t clockOverhead ( void )
+{
+	vector<uint64_t> samples;
+	for ( int index = 0; index < 10000; ++index )
+	{
+		Clock::time_point start = Clock::now();
+		Clock::time_point end = Clock::now();
+		samples.push_back ( chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+	}
+	nth_element ( samples.begin(), samples.begin() + samples.size()/2, samples.end() );
+	return samples[samples.size()/2];
+}
+
+// ===============================================================
+// =						Measurement
+// ===============================================================
+
+// Appends the getAction and run results of one agent on one size
+void measure ( const string &name, Agent *agent, const vector<WorldSpec> &specs, int warmup, int size, uint64_t seed, vector<Result> &results )
+{
+	vector<uint64_t> decisions;
+	vector<uint64_t> games;
+	decisions.reserve ( specs.size() * size * size * 4 );
+	games.reserve ( specs.size() );
+
+	// Time every decision
+	TimingAgent timingAgent ( agent, decisions );
+	World timedWorld ( &timingAgent );
+	for ( int index = 0; index < warmup; ++index )
+	{
+		timedWorld.reset ( specs[index % specs.size()], seed+index );
+		timedWorld.run();
+	}
+	decisions.clear();
+	for ( size_t index = 0; index < specs.size(); ++index )
+	{
+		timedWorld.reset ( specs[index], seed+index );
+		timedWorld.run();
+	}
+
+	// Time every game
+	World world ( agent );
+	for ( int index = 0; index < warmup; ++index )
+	{
+		world.reset ( specs[index % specs.size()], seed+index );
+		world.run();
+	}
+	for ( size_t index = 0; index < specs.size(); ++index )
+	{
+		world.reset ( specs[index], seed+index );
+		Clock::time_point start = Clock::now();
+		world.run();
+		Clock::time_point end = Clock::now();
+		games.push_back ( chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+	}
+
+	results.push_back ( summarize ( name, "getAction", size, "ns/decision", decisions ) );
+	results.push_back ( summarize ( name, "run", size, "ns/game", games ) );
+}
+
+// ===============================================================
+// =						Large Boards
+// ===============================================================
+
+struct ScaleResult
+{
+	string	agent;
+	int		size;
+	size_t	count;
+	double	actions;		// Per game
+	double	resetTime;		// Per game, in ns, without the agent's reset
+	double	engineTime;		// Per game, in ns, World::run without the agent
+	double	agentTime;		// Per game, in ns, the agent's reset and decisions
+	double	decisionTime;	// Per game, in ns, the agent's decisions only
+	long	peakMemory;		// Peak resident set size so far, in KiB
+};
+
+long peakMemory ( void )
+{
+	struct rusage usage;
+	getrusage ( RUSAGE_SELF, &usage );
+	return usage.ru_maxrss;
+}
+
+// Appends the scaling result of one agent on one size, every game is
+// generated right before it is played, so large worlds are never kept
+void measureScale ( const string &name, Agent *agent, int size, int numOfGames, int warmup, uint64_t seed, vector<ScaleResult> &results )
+{
+	vector<uint64_t> decisions;
+	TimingAgent timingAgent ( agent, decisions );
+	World world ( &timingAgent );
+	WorldSpec spec;
+
+	// Both agents play the same worlds
+	Random rng ( Random::deriveSeed ( seed, size ) );
+
+	uint64_t actions   = 0;
+	uint64_t resetTime = 0;
+	uint64_t runTime   = 0;
+	uint64_t agentTime = 0;
+	uint64_t decisionTime = 0;
+	for ( int index = 0; index < warmup + numOfGames; ++index )
+	{
+		spec.generate ( rng, size, size );
+		decisions.clear();
+
+		Clock::time_point start = Clock::now();
+		world.reset ( spec, seed+index );
+		Clock::time_point ready = Clock::now();
+		world.run();
+		Clock::time_point end = Clock::now();
+
+		if ( index < warmup )
+			continue;
+
+		uint64_t decided = 0;
+		for ( uint64_t sample : decisions )
+			decided += sample;
+
+		actions      += decisions.size();
+		resetTime    += chrono::duration_cast<chrono::nanoseconds> ( ready - start ).count() - timingAgent.lastResetTime();
+		runTime      += chrono::duration_cast<chrono::nanoseconds> ( end - ready ).count();
+		agentTime    += timingAgent.lastResetTime() + decided;
+		decisionTime += decided;
+	}
+
+	ScaleResult result;
+	result.agent        = name;
+	result.size         = size;
+	result.count        = numOfGames;
+	result.actions      = (double)actions / numOfGames;
+	result.resetTime    = (double)resetTime / numOfGames;
+	result.engineTime   = (double)( runTime - decisionTime ) / numOfGames;
+	result.agentTime    = (double)agentTime / numOfGames;
+	result.decisionTime = (double)decisionTime / numOfGames;
+	result.peakMemory   = peakMemory();
+	results.push_back ( result );
+}
+
+// Actions per second, from a mean number of actions and a mean time in ns
+double actionRate ( double actions, double time )
+{
+	return time > 0 ? actions * 1e9 / time : 0;
+}
+
+// ===============================================================
+// =						Engines
+// ===============================================================
+
+struct EngineResult
+{
+	string	agent;		// Whose games were played
+	string	engine;
+	int		size;
+	size_t	count;
+	double	steps;		// Per game
+	double	stepTime;	// Per game-step, in ns, the fastest pass
+	double	news;		// Calls to operator new per game
+	bool	matched;	// True if every game reached its recorded score
+};
+
+// Plays the actions of a trace on any state, as Rules::step does on the
+// GameState, for the dispatch to fixed states
+struct TraceReplay
+{
+	const Trace	&trace;
+	unsigned	&checksum;
+
+	template <typename State>
+	int operator() ( State &state )
+	{
+		unsigned sum = 0;
+		for ( size_t step = 0; step < trace.size(); ++step )
+		{
+			sum += state.stench() + state.breeze() + state.glitter() + state.bump + state.scream;
+			Rules::step ( state, trace.getAction ( step ) );
+		}
+		checksum += sum;
+		return state.score;
+	}
+};
+
+// Appends the results of the engines on one size, replaying traces of
+// the games agent played on specs
+void measureEngines ( const string &agent, const vector<WorldSpec> &specs, const vector<Trace> &traces, int size, vector<EngineResult> &results )
+{
+	const int passes = 5;
+	size_t numOfGames = traces.size();
+	size_t numOfSteps = 0;
+	for ( const Trace &trace : traces )
+		numOfSteps += trace.size();
+
+	// Batch, the games stream through a fixed number of lanes in lockstep,
+	// a lane takes the next game as soon as its game is over
+	size_t numOfLanes = min ( numOfGames, (size_t)64 );
+	vector<uint8_t>	actions ( numOfLanes );
+	vector<uint8_t>	percepts ( numOfLanes );
+	vector<size_t>	gameOf ( numOfLanes );
+	vector<size_t>	stepOf ( numOfLanes );
+
+	// The actions of all games in one array, each lane reads its game's
+	// from there as the World reads them from its Agent
+	vector<uint8_t>	allActions;
+	vector<size_t>	firstStep ( numOfGames );
+	vector<uint8_t>	records ( numOfGames * Corpus::RECORD_SIZE );	// The worlds, as a corpus holds them
+	for ( size_t game = 0; game < numOfGames; ++game )
+	{
+		Corpus::encode ( specs[game], records.data() + game*Corpus::RECORD_SIZE );
+		firstStep[game] = allActions.size();
+		for ( size_t step = 0; step < traces[game].size(); ++step )
+			allActions.push_back ( traces[game].getAction ( step ) );
+		allActions.push_back ( Agent::CLIMB );
+	}
+	BatchWorld batch ( numOfLanes );
+
+	// Every pass plays all games on each engine in turn, so that a slow
+	// spell of the machine slows them alike
+	uint64_t rulesTime = UINT64_MAX, fixedTime = UINT64_MAX, batchTime = UINT64_MAX;
+	bool rulesMatched = true, fixedMatched = true, batchMatched = true;
+	uint64_t rulesNews = 0, fixedNews = 0, batchNews = 0;
+	unsigned checksum = 0;
+	GameState state;
+	for ( int pass = 0; pass < passes; ++pass )
+	{
+		// Rules, game after game, as World::run plays
+		uint64_t news = numOfNews;
+		Clock::time_point start = Clock::now();
+		for ( const Trace &trace : traces )
+		{
+			state = trace.getStart();
+			unsigned sum = 0;
+			for ( size_t step = 0; step < trace.size(); ++step )
+			{
+				sum += state.stench() + state.breeze() + state.glitter() + state.bump + state.scream;
+				Rules::step ( state, trace.getAction ( step ) );
+			}
+			checksum += sum;
+			rulesMatched = rulesMatched && state.score == trace.getScore();
+		}
+		Clock::time_point end = Clock::now();
+		rulesTime = min ( rulesTime, (uint64_t)chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+		rulesNews += numOfNews - news;
+
+		// Fixed, the same on the FixedState of each board's size
+		news  = numOfNews;
+		start = Clock::now();
+		for ( const Trace &trace : traces )
+		{
+			state = trace.getStart();
+			TraceReplay replay = { trace, checksum };
+			fixedMatched = fixedMatched && playOnFixedState ( state, replay ) == trace.getScore();
+		}
+		end = Clock::now();
+		fixedTime = min ( fixedTime, (uint64_t)chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+		fixedNews += numOfNews - news;
+
+		// Batch
+		size_t nextGame = 0;
+		for ( size_t lane = 0; lane < numOfLanes; ++lane )
+		{
+			gameOf[lane] = numOfGames;
+			stepOf[lane] = 0;
+		}
+
+		// A game that is over perceives GAME_OVER alone, and its lane
+		// takes the next game then, before the actions are read. A lane
+		// left without a game reads the first action again and again.
+		// The arrays are read through local pointers, as an action
+		// stored through a byte pointer would make the compiler reload
+		// every array's address
+		const uint8_t	*perceptOf = percepts.data();
+		uint8_t			*actionOf  = actions.data();
+		size_t			*laneStep  = stepOf.data();
+		news  = numOfNews;
+		start = Clock::now();
+		while ( true )
+		{
+			unsigned sum = 0;
+			batch.getPercepts ( percepts.data() );
+			for ( size_t lane = 0; lane < numOfLanes; ++lane )
+			{
+				uint8_t percept = perceptOf[lane];
+				if ( percept == BatchWorld::GAME_OVER )
+				{
+					if ( gameOf[lane] < numOfGames )
+						batchMatched = batchMatched && batch.getScore ( lane ) == traces[gameOf[lane]].getScore();
+					gameOf[lane]   = numOfGames;
+					laneStep[lane] = 0;
+					if ( nextGame < numOfGames )
+					{
+						batch.reset ( lane, records.data() + nextGame*Corpus::RECORD_SIZE );
+						laneStep[lane] = firstStep[nextGame];
+						gameOf[lane]   = nextGame++;
+					}
+				}
+				sum += percept;
+				actionOf[lane] = allActions[laneStep[lane]++];
+			}
+			checksum += sum;
+			if ( batch.getNumOfLive() == 0 )
+				break;
+
+			batch.step ( actions.data() );
+		}
+		end = Clock::now();
+		batchTime = min ( batchTime, (uint64_t)chrono::duration_cast<chrono::nanoseconds> ( end - start ).count() );
+		batchNews += numOfNews - news;
+	}
+
+	// Keeps the percepts from being optimized away
+	if ( checksum == 1 )
+		cout << "";
+
+	double numOfPlays = (double)numOfGames * passes;
+	EngineResult rules = { agent, "rules", size, numOfGames, (double)numOfSteps / numOfGames, (double)rulesTime / numOfSteps, rulesNews / numOfPlays, rulesMatched };
+	EngineResult batched = { agent, "batch", size, numOfGames, (double)numOfSteps / numOfGames, (double)batchTime / numOfSteps, batchNews / numOfPlays, batchMatched };
+	EngineResult fixed = { agent, "fixed", size, numOfGames, (double)numOfSteps / numOfGames, (double)fixedTime / numOfSteps, fixedNews / numOfPlays, fixedMatched };
+	results.push_back ( rules );
+	results.push_back ( fixed );
+	results.push_back ( batched );
+}
+
+// Appends the results of the agents of factory playing the games of traces
+// again on specs, from their seeds, one game at a time, in lockstep and in
+// the Simulator, and of native, the same agent deciding its games together,
+// in lockstep, unless it is null
+void measureAgents ( const string &agent, const AgentFactory &factory, BatchAgent *native, const vector<WorldSpec> &specs, const vector<Trace> &traces, uint64_t seed, int size, vector<EngineResult> &results )
+{
+	size_t numOfGames = traces.size();
+	size_t numOfSteps = 0;
+	for ( const Trace &trace : traces )
+		numOfSteps += trace.size();
+
+	// World, one agent for every game in turn
+	unique_ptr<Agent> single ( factory() );
+	World world ( single.get() );
+	bool worldMatched = true;
+	uint64_t worldNews = numOfNews;
+	Clock::time_point start = Clock::now();
+	for ( size_t game = 0; game < numOfGames; ++game )
+	{
+		world.reset ( specs[game], seed+game );
+		worldMatched = worldMatched && world.run() == traces[game].getScore();
+	}
+	Clock::time_point end = Clock::now();
+	uint64_t worldTime = chrono::duration_cast<chrono::nanoseconds> ( end - start ).count();
+	worldNews = numOfNews - worldNews;
+
+	// Lockstep, one agent per game of a BatchWorld through the adapter
+	size_t numOfLanes = min ( numOfGames, (size_t)256 );
+	BatchAdapter adapter ( factory, numOfLanes );
+	BatchWorld batch ( numOfLanes );
+	vector<int> scores ( numOfGames );
+	uint64_t batchNews = numOfNews;
+	start = Clock::now();
+	batch.play ( adapter, specs.data(), numOfGames, scores.data(), seed );
+	end = Clock::now();
+	uint64_t batchTime = chrono::duration_cast<chrono::nanoseconds> ( end - start ).count();
+	batchNews = numOfNews - batchNews;
+
+	bool batchMatched = true;
+	for ( size_t game = 0; game < numOfGames; ++game )
+		batchMatched = batchMatched && scores[game] == traces[game].getScore();
+
+	// Native, the batch agent in the same BatchWorld
+	uint64_t nativeTime = 0;
+	uint64_t nativeNews = numOfNews;
+	bool nativeMatched = true;
+	if ( native )
+	{
+		fill ( scores.begin(), scores.end(), 0 );
+		start = Clock::now();
+		batch.play ( *native, specs.data(), numOfGames, scores.data(), seed );
+		end = Clock::now();
+		nativeTime = chrono::duration_cast<chrono::nanoseconds> ( end - start ).count();
+
+		for ( size_t game = 0; game < numOfGames; ++game )
+			nativeMatched = nativeMatched && scores[game] == traces[game].getScore();
+	}
+	nativeNews = numOfNews - nativeNews;
+
+	// Simulator, the second batch, once the first has made its agent and World
+	Simulator simulator ( factory, 1 );
+	simulator.simulateBatch ( specs.data(), numOfGames, scores.data(), seed );
+	fill ( scores.begin(), scores.end(), 0 );
+	uint64_t simulatorNews = numOfNews;
+	start = Clock::now();
+	simulator.simulateBatch ( specs.data(), numOfGames, scores.data(), seed );
+	end = Clock::now();
+	uint64_t simulatorTime = chrono::duration_cast<chrono::nanoseconds> ( end - start ).count();
+	simulatorNews = numOfNews - simulatorNews;
+
+	bool simulatorMatched = true;
+	for ( size_t game = 0; game < numOfGames; ++game )
+		simulatorMatched = simulatorMatched && scores[game] == traces[game].getScore();
+
+	EngineResult one = { agent, "world", size, numOfGames, (double)numOfSteps / numOfGames, (double)worldTime / numOfSteps, (double)worldNews / numOfGames, worldMatched };
+	EngineResult lockstep = { agent, "lockstep", size, numOfGames, (double)numOfSteps / numOfGames, (double)batchTime / numOfSteps, (double)batchNews / numOfGames, batchMatched };
+	EngineResult simulated = { agent, "simulator", size, numOfGames, (double)numOfSteps / numOfGames, (double)simulatorTime / numOfSteps, (double)simulatorNews / numOfGames, simulatorMatched };
+	EngineResult batchNative = { agent, "native", size, numOfGames, (double)numOfSteps / numOfGames, (double)nativeTime / numOfSteps, (double)nativeNews / numOfGames, nativeMatched };
+	results.push_back ( one );
+	results.push_back ( lockstep );
+	if ( native )
+		results.push_back ( batchNative );
+	results.push_back ( simulated );
+}
+
+// ===============================================================
+// =						Output
+// ===============================================================
+
+void printTable ( const vector<Result> &results, uint64_t overhead )
+{
+	cout << "Clock overhead: " << overhead << " ns" << endl;
+	cout << left << setw(10) << "agent" << setw(11) << "metric" << setw(6) << "size"
+		 << right << setw(10) << "count" << setw(12) << "mean" << setw(10) << "p50"
+		 << setw(10) << "p90" << setw(10) << "p99" << setw(12) << "max" << endl;
+
+	for ( const Result &result : results )
+		cout << left << setw(10) << result.agent << setw(11) << result.metric
+			 << setw(6) << ( to_string ( result.size ) + "x" + to_string ( result.size ) )
+			 << right << setw(10) << result.count << setw(12) << fixed << setprecision(1) << result.mean
+			 << setw(10) << result.p50 << setw(10) << result.p90 << setw(10) << result.p99
+			 << setw(12) << result.max << endl;
+}
+
+void printCSV ( const vector<Result> &results, uint64_t overhead )
+{
+	cout << "agent,metric,size,unit,count,mean,p50,p90,p99,max,clock_overhead" << endl;
+	for ( const Result &result : results )
+		cout << result.agent << ',' << result.metric << ',' << result.size << ',' << result.unit << ','
+			 << result.count << ',' << fixed << setprecision(1) << result.mean << ',' << result.p50 << ','
+			 << result.p90 << ',' << result.p99 << ',' << result.max << ',' << overhead << endl;
+}
+
+void printJSON ( const vector<Result> &results, uint64_t overhead, int numOfGames, int warmup, uint64_t seed )
+{
+	cout << "{\n  \"games\": " << numOfGames << ",\n  \"warmup\": " << warmup
+		 << ",\n  \"seed\": " << seed << ",\n  \"clock_overhead\": " << overhead
+		 << ",\n  \"results\": [";
+
+	for ( size_t index = 0; index < results.size(); ++index )
+	{
+		const Result &result = results[index];
+		cout << ( index ? "," : "" ) << "\n    {\"agent\": \"" << result.agent
+			 << "\", \"metric\": \"" << result.metric << "\", \"size\": " << result.size
+			 << ", \"unit\": \"" << result.unit << "\", \"count\": " << result.count
+			 << ", \"mean\": " << fixed << setprecision(1) << result.mean
+			 << ", \"p50\": " << result.p50 << ", \"p90\": " << result.p90
+			 << ", \"p99\": " << result.p99 << ", \"max\": " << result.max << "}";
+	}
+	cout << "\n  ]\n}" << endl;
+}
+
+void printScaleTable ( const vector<ScaleResult> &results )
+{
+	cout << left << setw(10) << "agent" << setw(11) << "size"
+		 << right << setw(7) << "games" << setw(10) << "actions" << setw(13) << "reset ns"
+		 << setw(13) << "engine ns" << setw(13) << "agent ns" << setw(14) << "engine act/s"
+		 << setw(14) << "agent act/s" << setw(12) << "peak KiB" << endl;
+
+	for ( const ScaleResult &result : results )
+		cout << left << setw(10) << result.agent
+			 << setw(11) << ( to_string ( result.size ) + "x" + to_string ( result.size ) )
+			 << right << setw(7) << result.count << fixed << setprecision(1)
+			 << setw(10) << result.actions << setw(13) << result.resetTime
+			 << setw(13) << result.engineTime << setw(13) << result.agentTime << setprecision(0)
+			 << setw(14) << actionRate ( result.actions, result.engineTime )
+			 << setw(14) << actionRate ( result.actions, result.decisionTime )
+			 << setw(12) << result.peakMemory << endl;
+}
+
+void printScaleCSV ( const vector<ScaleResult> &results )
+{
+	cout << "agent,size,count,actions,reset_ns,engine_ns,agent_ns,engine_actions_per_s,agent_actions_per_s,peak_kib" << endl;
+	for ( const ScaleResult &result : results )
+		cout << result.agent << ',' << result.size << ',' << result.count << ',' << fixed << setprecision(1)
+			 << result.actions << ',' << result.resetTime << ',' << result.engineTime << ','
+			 << result.agentTime << ',' << setprecision(0) << actionRate ( result.actions, result.engineTime ) << ','
+			 << actionRate ( result.actions, result.decisionTime ) << ',' << result.peakMemory << endl;
+}
+
+void printScaleJSON ( const vector<ScaleResult> &results, int numOfGames, int warmup, uint64_t seed )
+{
+	cout << "{\n  \"games\": " << numOfGames << ",\n  \"warmup\": " << warmup
+		 << ",\n  \"seed\": " << seed << ",\n  \"results\": [";
+
+	for ( size_t index = 0; index < results.size(); ++index )
+	{
+		const ScaleResult &result = results[index];
+		cout << ( index ? "," : "" ) << "\n    {\"agent\": \"" << result.agent
+			 << "\", \"size\": " << result.size << ", \"count\": " << result.count
+			 << fixed << setprecision(1) << ", \"actions\": " << result.actions
+			 << ", \"reset_ns\": " << result.resetTime << ", \"engine_ns\": " << result.engineTime
+			 << ", \"agent_ns\": " << result.agentTime << setprecision(0)
+			 << ", \"engine_actions_per_s\": " << actionRate ( result.actions, result.engineTime )
+			 << ", \"agent_actions_per_s\": " << actionRate ( result.actions, result.decisionTime )
+			 << ", \"peak_kib\": " << result.peakMemory << "}";
+	}
+	cout << "\n  ]\n}" << endl;
+}
+
+void printEngineTable ( const vector<EngineResult> &results )
+{
+	cout << left << setw(10) << "agent" << setw(10) << "engine" << setw(11) << "size"
+		 << right << setw(7) << "games" << setw(10) << "steps" << setw(12) << "ns/step"
+		 << setw(14) << "steps/s" << setw(10) << "new/game" << setw(10) << "matched" << endl;
+
+	for ( const EngineResult &result : results )
+		cout << left << setw(10) << result.agent << setw(10) << result.engine
+			 << setw(11) << ( to_string ( result.size ) + "x" + to_string ( result.size ) )
+			 << right << setw(7) << result.count << fixed << setprecision(1)
+			 << setw(10) << result.steps << setprecision(2) << setw(12) << result.stepTime << setprecision(0)
+			 << setw(14) << actionRate ( 1, result.stepTime ) << setprecision(2)
+			 << setw(10) << result.news << setw(10) << ( result.matched ? "yes" : "NO" ) << endl;
+}
+
+void printEngineCSV ( const vector<EngineResult> &results )
+{
+	cout << "agent,engine,size,count,steps,ns_per_step,steps_per_s,news_per_game,matched" << endl;
+	for ( const EngineResult &result : results )
+		cout << result.agent << ',' << result.engine << ',' << result.size << ',' << result.count << ',' << fixed << setprecision(1)
+			 << result.steps << ',' << setprecision(2) << result.stepTime << ',' << setprecision(0)
+			 << actionRate ( 1, result.stepTime ) << ',' << setprecision(2) << result.news << ','
+			 << ( result.matched ? "true" : "false" ) << endl;
+}
+
+void printEngineJSON ( const vector<EngineResult> &results, int numOfGames, uint64_t seed )
+{
+	cout << "{\n  \"games\": " << numOfGames << ",\n  \"seed\": " << seed << ",\n  \"results\": [";
+
+	for ( size_t index = 0; index < results.size(); ++index )
+	{
+		const EngineResult &result = results[index];
+		cout << ( index ? "," : "" ) << "\n    {\"agent\": \"" << result.agent
+			 << "\", \"engine\": \"" << result.engine
+			 << "\", \"size\": " << result.size << ", \"count\": " << result.count
+			 << fixed << setprecision(1) << ", \"steps\": " << result.steps
+			 << setprecision(2) << ", \"ns_per_step\": " << result.stepTime << setprecision(0)
+			 << ", \"steps_per_s\": " << actionRate ( 1, result.stepTime ) << setprecision(2)
+			 << ", \"news_per_game\": " << result.news
+			 << ", \"matched\": " << ( result.matched ? "true" : "false" ) << "}";
+	}
+	cout << "\n  ]\n}" << endl;
+}
+
+// ===============================================================
+// =						Entry Point
+// ===============================================================
+
+// Reads the number following the option letter at index
+uint64_t parseNumber ( const string &token, size_t &index )
+{
+	uint64_t value = 0;
+	while ( index+1 < token.size() && isdigit ( token[index+1] ) )
+		value = value*10 + ( token[++index] - '0' );
+	return value;
+}
+
+int main ( int argc, char *argv[] )
+{
+	int			numOfGames = 2000;
+	int			warmup     = 200;
+	uint64_t	seed       = 1;
+	char		format     = 't';
+	bool		scaling    = false;
+	bool		engines    = false;
+	int			maxSize    = 1024;
+	bool		gamesSet   = false;
+	bool		warmupSet  = false;
+
+	if ( argc > 1 )
+	{
+		string firstToken = argv[1];
+		if ( firstToken[0] != '-' )
+		{
+			cout << "[ERROR] Invalid option, use -h for help." << endl;
+			return 0;
+		}
+
+		for ( size_t index = 1; index < firstToken.size(); ++index )
+		{
+			switch ( tolower ( firstToken[index] ) )
+			{
+				case '-':
+					break;
+
+				case 'g':
+					numOfGames = parseNumber ( firstToken, index );
+					gamesSet = true;
+					break;
+
+				case 'w':
+					warmup = parseNumber ( firstToken, index );
+					warmupSet = true;
+					break;
+
+				case 'l':
+					scaling = true;
+					break;
+
+				case 'e':
+					engines = true;
+					break;
+
+				case 'm':
+					maxSize = parseNumber ( firstToken, index );
+					break;
+
+				case 's':
+					seed = parseNumber ( firstToken, index );
+					break;
+
+				case 'c':
+					format = 'c';
+					break;
+
+				case 'o':
+					format = 'o';
+					break;
+
+				case 'h':
+				default:
+					cout << "Usage: Wumpus_World_Bench [Options]" << endl << endl;
+					cout << "Options:" << endl;
+					cout << "  -gN plays N measured games per agent and size (default 2000, 20 with -l, 10000 with -e)." << endl;
+					cout << "  -wN plays N warmup games per agent and size (default 200, 2 with -l)." << endl;
+					cout << "  -l  measures scaling on boards from 4x4 up to 1024x1024." << endl;
+					cout << "  -e  measures the engines, and the agents in them and in the Simulator." << endl;
+					cout << "  -mN stops -l at boards of N x N (default 1024)." << endl;
+					cout << "  -sN seeds the worlds with N (default 1)." << endl;
+					cout << "  -c  prints CSV instead of a table." << endl;
+					cout << "  -o  prints JSON instead of a table." << endl;
+					cout << "  -h  Displays help menu and quits." << endl;
+					return 0;
+			}
+		}
+	}
+
+	if ( scaling && !gamesSet )
+		numOfGames = 20;
+	if ( scaling && !warmupSet )
+		warmup = 2;
+	if ( engines && !gamesSet )
+		numOfGames = 10000;
+
+	if ( numOfGames < 1 )
+	{
+		cout << "[ERROR] At least one game must be measured." << endl;
+		return 0;
+	}
+
+	MyAI		myAI;
+	RandomAI	randomAI;
+
+	if ( scaling )
+	{
+		vector<ScaleResult> results;
+		for ( int size = 4; size <= maxSize; size *= 2 )
+		{
+			measureScale ( "MyAI", &myAI, size, numOfGames, warmup, seed, results );
+			measureScale ( "RandomAI", &randomAI, size, numOfGames, warmup, seed, results );
+		}
+
+		if ( format == 'c' )
+			printScaleCSV ( results );
+		else if ( format == 'o' )
+			printScaleJSON ( results, numOfGames, warmup, seed );
+		else
+			printScaleTable ( results );
+		return 0;
+	}
+
+	if ( engines )
+	{
+		vector<EngineResult> results;
+		World myWorld ( &myAI );
+		World randomWorld ( &randomAI );
+		BatchRandomAI batchRandomAI ( 256 );	// As many games as the lockstep rows play
+		Trace trace;
+		myWorld.setTrace ( &trace );
+		randomWorld.setTrace ( &trace );
+		for ( int size = 4; size <= BatchWorld::MAX_DIMENSION; ++size )
+		{
+			Random rng ( Random::deriveSeed ( seed, size ) );
+			vector<WorldSpec> specs ( numOfGames );
+			for ( WorldSpec &spec : specs )
+				spec.generate ( rng, size, size );
+
+			// RandomAI shoots and walks anywhere, so its games reach the
+			// cases MyAI avoids, like a wumpus shot over a pit
+			vector<Trace> myTraces;
+			vector<Trace> randomTraces;
+			for ( int index = 0; index < numOfGames; ++index )
+			{
+				myWorld.reset ( specs[index], seed+index );
+				myWorld.run();
+				myTraces.push_back ( trace );
+				randomWorld.reset ( specs[index], seed+index );
+				randomWorld.run();
+				randomTraces.push_back ( trace );
+			}
+			measureEngines ( "MyAI", specs, myTraces, size, results );
+			measureEngines ( "RandomAI", specs, randomTraces, size, results );
+			measureAgents ( "MyAI", [] () { return new MyAI(); }, nullptr, specs, myTraces, seed, size, results );
+			measureAgents ( "RandomAI", [] () { return new RandomAI(); }, &batchRandomAI, specs, randomTraces, seed, size, results );
+		}
+
+		if ( format == 'c' )
+			printEngineCSV ( results );
+		else if ( format == 'o' )
+			printEngineJSON ( results, numOfGames, seed );
+		else
+			printEngineTable ( results );
+		return 0;
+	}
+
+	vector<Result> results;
+	for ( int size = 4; size <= 8; ++size )
+	{
+		// Both agents play the same worlds
+		Random rng ( Random::deriveSeed ( seed, size ) );
+		vector<WorldSpec> specs ( numOfGames );
+		for ( WorldSpec &spec : specs )
+			spec.generate ( rng, size, size );
+
+		measure ( "MyAI", &myAI, specs, warmup, size, seed, results );
+		measure ( "RandomAI", &randomAI, specs, warmup, size, seed, results );
+	}
+
+	uint64_t overhead = clockOverhead();
+	if ( format == 'c' )
+		printCSV ( results, overhead );
+	else if ( format == 'o' )
+		printJSON ( results, overhead, numOfGames, warmup, seed );
+	else
+		printTable ( results, overhead );
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+// ======================================================================
+// FILE:        BoundedQueue.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains a bounded lock-free queue for any
+//              number of producer and consumer threads, Dmitry Vyukov's
+//              array-based design. Every cell carries a sequence number
+//              that tells whether it is ready to be written or read in
+//              the current lap, so a push or pop costs one compare and
+//              swap and never waits on a lock.
+//
+// NOTES:       - tryPush and tryPop never block; they return false when
+//                the queue is full or empty, and the caller decides
+//                whether to retry or yield.
+//
+//              - Items are copy-assigned in and out of the cells, so an
+//                item holding a vector reuses the cell's memory once it
+//                has grown large enough.
+// ======================================================================
+
+#ifndef BOUNDEDQUEUE_LOCK
+#define BOUNDEDQUEUE_LOCK
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+template <typename T>
+class BoundedQueue
+{
+public:
+
+	// The capacity is rounded up to a power of two
+	explicit BoundedQueue ( size_t capacity )
+	{
+		size_t size = 2;
+		while ( size < capacity )
+			size *= 2;
+
+		cells.reset ( new Cell[size] );
+		mask = size - 1;
+		for ( size_t index = 0; index < size; ++index )
+			cells[index].sequence.store ( index, std::memory_order_relaxed );
+
+		enqueuePos.store ( 0, std::memory_order_relaxed );
+		dequeuePos.store ( 0, std::memory_order_relaxed );
+	}
+
+	// Copies item to the back, returns false if the queue is full
+	bool tryPush ( const T &item )
+	{
+		Cell *cell;
+		size_t pos = enqueuePos.load ( std::memory_order_relaxed );
+		for ( ;; )
+		{
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load ( std::memory_order_acquire );
+			intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+
+			// The cell is free in this lap, try to claim it
+			if ( diff == 0 )
+			{
+				if ( enqueuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			// The cell still holds an item of the previous lap
+			else if ( diff < 0 )
+				return false;
+			// Another producer claimed the cell first
+			else
+				pos = enqueuePos.load ( std::memory_order_relaxed );
+		}
+
+		cell->data = item;
+		cell->sequence.store ( pos + 1, std::memory_order_release );
+		return true;
+	}
+
+	// Copies the front into item and removes it, returns false if the queue is empty
+	bool tryPop ( T &item )
+	{
+		Cell *cell;
+		size_t pos = dequeuePos.load ( std::memory_order_relaxed );
+		for ( ;; )
+		{
+			cell = &cells[pos & mask];
+			size_t sequence = cell->sequence.load ( std::memory_order_acquire );
+			intptr_t diff = (intptr_t)sequence - (intptr_t)( pos + 1 );
+
+			// The cell holds an item of this lap, try to claim it
+			if ( diff == 0 )
+			{
+				if ( dequeuePos.compare_exchange_weak ( pos, pos + 1, std::memory_order_relaxed ) )
+					break;
+			}
+			// The cell has not been written in this lap yet
+			else if ( diff < 0 )
+				return false;
+			// Another consumer claimed the cell first
+			else
+				pos = dequeuePos.load ( std::memory_order_relaxed );
+		}
+
+		item = cell->data;
+		cell->sequence.store ( pos + mask + 1, std::memory_order_release );
+		return true;
+	}
+
+private:
+
+	BoundedQueue ( const BoundedQueue& ) = delete;
+	BoundedQueue& operator= ( const BoundedQueue& ) = delete;
+
+	struct Cell
+	{
+		std::atomic<size_t>	sequence;	// Lap in which the cell can be written or read
+		T					data;
+	};
+
+	// Padding keeps the two positions on their own cache lines, so
+	// producers and consumers do not invalidate each other's line
+	std::unique_ptr<Cell[]>	cells;
+	size_t					mask;
+	char					pad0[64];
+	std::atomic<size_t>		enqueuePos;		// Next position to push
+	char					pad1[64];
+	std::atomic<size_t>		dequeuePos;		// Next position to pop
+	char					pad2[64];
+};
+
+#endif /* BOUNDEDQUEUE_LOCK */
@@ -0,0 +1,203 @@
+// ======================================================================
+// FILE:        Corpus.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the corpus class, a set of worlds
+//              packed into one memory-mapped binary file.
+// ======================================================================
+
+#include "Corpus.hpp"
+
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char MAGIC[8] = { 'W', 'W', 'C', 'O', 'R', 'P', '0', '1' };
+
+static uint64_t readUint64 ( const uint8_t *bytes )
+{
+	uint64_t value = 0;
+	for ( int index = 7; index >= 0; --index )
+		value = value << 8 | bytes[index];
+	return value;
+}
+
+static void writeUint64 ( uint64_t value, uint8_t *bytes )
+{
+	for ( int index = 0; index < 8; ++index )
+		bytes[index] = value >> ( 8*index );
+}
+
+// The pit bits of the tiles of a board of cols x rows
+static uint64_t boardTiles ( int cols, int rows )
+{
+	uint64_t tiles = 0;
+	for ( int r = 0; r < rows; ++r )
+		tiles |= ( ( 1ULL << cols ) - 1 ) << ( r*Corpus::MAX_DIMENSION );
+	return tiles;
+}
+
+// True if the record's board is 1x1 to 8x8 and every feature is on it
+static bool isValid ( const uint8_t *record )
+{
+	int cols = record[0];
+	int rows = record[1];
+	if ( cols < 1 || cols > Corpus::MAX_DIMENSION || rows < 1 || rows > Corpus::MAX_DIMENSION )
+		return false;
+
+	return record[2] < cols && record[3] < rows && record[4] < cols && record[5] < rows
+		&& ( readUint64 ( record + 8 ) & ~boardTiles ( cols, rows ) ) == 0;
+}
+
+// ===============================================================
+// =				Constructor and Destructor
+// ===============================================================
+
+Corpus::Corpus ( void )
+{
+	data         = nullptr;
+	length       = 0;
+	numOfRecords = 0;
+}
+
+Corpus::~Corpus()
+{
+	close();
+}
+
+// ===============================================================
+// =					Mapping Functions
+// ===============================================================
+
+void Corpus::open ( const string &filename )
+{
+	close();
+
+	int fd = ::open ( filename.c_str(), O_RDONLY );
+	if ( fd == -1 )
+		throw exception();
+
+	struct stat info;
+	if ( fstat ( fd, &info ) == -1 || info.st_size < (off_t)HEADER_SIZE )
+	{
+		::close ( fd );
+		throw exception();
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	void *mapping = mmap ( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close ( fd );
+	if ( mapping == MAP_FAILED )
+		throw exception();
+
+	data   = (const uint8_t*)mapping;
+	length = info.st_size;
+
+	uint64_t count = readUint64 ( data + sizeof(MAGIC) );
+	if ( memcmp ( data, MAGIC, sizeof(MAGIC) ) != 0 || count > ( length - HEADER_SIZE ) / RECORD_SIZE )
+	{
+		close();
+		throw exception();
+	}
+
+	// Every record is checked once here, so get never meets a bad one
+	for ( uint64_t index = 0; index < count; ++index )
+		if ( !isValid ( data + HEADER_SIZE + index*RECORD_SIZE ) )
+		{
+			close();
+			throw exception();
+		}
+	numOfRecords = count;
+
+	// Worlds are read front to back
+	madvise ( mapping, length, MADV_SEQUENTIAL );
+}
+
+void Corpus::close ( void )
+{
+	if ( data != nullptr )
+		munmap ( (void*)data, length );
+
+	data         = nullptr;
+	length       = 0;
+	numOfRecords = 0;
+}
+
+// ===============================================================
+// =					Record Functions
+// ===============================================================
+
+void Corpus::get ( size_t index, WorldSpec &spec ) const
+{
+	decode ( data + HEADER_SIZE + index*RECORD_SIZE, spec );
+}
+
+void Corpus::encode ( const WorldSpec &spec, uint8_t *record )
+{
+	int fields[6] = { spec.colDimension, spec.rowDimension, spec.wumpusC, spec.wumpusR, spec.goldC, spec.goldR };
+
+	if ( spec.colDimension < 1 || spec.colDimension > MAX_DIMENSION || spec.rowDimension < 1 || spec.rowDimension > MAX_DIMENSION )
+		throw exception();
+	if ( spec.wumpusC < 0 || spec.wumpusC >= spec.colDimension || spec.wumpusR < 0 || spec.wumpusR >= spec.rowDimension
+		|| spec.goldC < 0 || spec.goldC >= spec.colDimension || spec.goldR < 0 || spec.goldR >= spec.rowDimension )
+		throw exception();
+
+	for ( int index = 0; index < 6; ++index )
+	{
+		if ( fields[index] < 0 || fields[index] > 255 )
+			throw exception();
+		record[index] = fields[index];
+	}
+	record[6] = 0;
+	record[7] = 0;
+
+	uint64_t pits = 0;
+	for ( size_t index = 0; index < spec.pits.size(); ++index )
+	{
+		int c = spec.pits[index].first;
+		int r = spec.pits[index].second;
+		if ( c >= 0 && c < spec.colDimension && r >= 0 && r < spec.rowDimension )
+			pits |= 1ULL << ( r*MAX_DIMENSION + c );
+	}
+	writeUint64 ( pits, record + 8 );
+}
+
+void Corpus::decode ( const uint8_t *record, WorldSpec &spec )
+{
+	spec.colDimension = record[0];
+	spec.rowDimension = record[1];
+	spec.wumpusC      = record[2];
+	spec.wumpusR      = record[3];
+	spec.goldC        = record[4];
+	spec.goldR        = record[5];
+
+	spec.pits.clear();
+	for ( uint64_t pits = readUint64 ( record + 8 ); pits; pits &= pits - 1 )
+	{
+		int tile = __builtin_ctzll ( pits );
+		spec.pits.push_back ( make_pair ( tile % MAX_DIMENSION, tile / MAX_DIMENSION ) );
+	}
+}
+
+void Corpus::write ( const string &filename, const vector<WorldSpec> &specs )
+{
+	vector<uint8_t> bytes ( HEADER_SIZE + specs.size()*RECORD_SIZE );
+
+	memcpy ( bytes.data(), MAGIC, sizeof(MAGIC) );
+	writeUint64 ( specs.size(), bytes.data() + sizeof(MAGIC) );
+	for ( size_t index = 0; index < specs.size(); ++index )
+		encode ( specs[index], bytes.data() + HEADER_SIZE + index*RECORD_SIZE );
+
+	ofstream file ( filename, ios::binary );
+	file.write ( (const char*)bytes.data(), bytes.size() );
+	file.close();
+	if ( file.fail() )
+		throw exception();
+}
@@ -0,0 +1,82 @@
+// ======================================================================
+// FILE:        Corpus.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the corpus class, a set of worlds
+//              packed into one binary file. Opening a corpus maps the
+//              file into memory, so a tournament reads its worlds
+//              straight from the page cache instead of opening and
+//              parsing one text file per world.
+//
+// NOTES:       - File layout, all integers little-endian:
+//
+//                  Header, 16 bytes:
+//                      8 bytes  magic "WWCORP01"
+//                      8 bytes  number of records
+//
+//                  Record, 16 bytes, one per world:
+//                      1 byte   colDimension
+//                      1 byte   rowDimension
+//                      1 byte   wumpusC, wumpusR, goldC, goldR each
+//                      2 bytes  reserved, zero
+//                      8 bytes  pits, tile (c, r) is bit r*8+c
+//
+//              - Boards are 1x1 to 8x8, and the wumpus and the gold must
+//                be on the board. A pit off the board is ignored by the
+//                Rules, so it is dropped when packing. Opening a corpus
+//                checks every record, so a corrupt file is refused.
+// ======================================================================
+
+#ifndef CORPUS_LOCK
+#define CORPUS_LOCK
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+#include"WorldSpec.hpp"
+
+class Corpus
+{
+public:
+
+	static const int	MAX_DIMENSION = 8;		// Largest board a record can hold
+	static const size_t	HEADER_SIZE   = 16;
+	static const size_t	RECORD_SIZE   = 16;
+
+	// Constructor and Destructor
+	Corpus ( void );
+	~Corpus();
+
+	// Maps a corpus file, throws std::exception if it is not a valid corpus
+	void	open	( const std::string &filename );
+
+	// Unmaps the file
+	void	close	( void );
+
+	// Number of worlds in the corpus
+	size_t	size	( void ) const { return numOfRecords; }
+
+	// Fills spec with the index-th world, reusing its memory
+	void	get		( size_t index, WorldSpec &spec ) const;
+
+	// Packs specs into a corpus file, throws std::exception if a spec
+	// does not fit in a record or the file cannot be written
+	static void	write	( const std::string &filename, const std::vector<WorldSpec> &specs );
+
+	// Record conversions, record points to RECORD_SIZE bytes
+	static void	encode	( const WorldSpec &spec, uint8_t *record );
+	static void	decode	( const uint8_t *record, WorldSpec &spec );
+
+private:
+
+	Corpus ( const Corpus& ) = delete;
+	Corpus& operator= ( const Corpus& ) = delete;
+
+	const uint8_t	*data;			// The mapped file, nullptr if closed
+	size_t			length;			// Length of the mapping in bytes
+	size_t			numOfRecords;	// Number of worlds
+};
+
+#endif /* CORPUS_LOCK */
@@ -0,0 +1,490 @@
+// ======================================================================
+// FILE:        Evaluator.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the evaluator class, which works out
+//              the exact expected score of an agent on random worlds of
+//              one size, as World::addFeatures lays them out: a pit in
+//              every tile but (0,0) with probability 2/10, and the
+//              wumpus and the gold each in a uniform tile but (0,0).
+//
+//              Instead of playing every world, it plays the agent once
+//              for every distinct game. The features start hidden, and
+//              a game runs until it needs one the agent has not yet
+//              felt, whether a pit, the wumpus or the gold is in some
+//              tile. There it splits into a game where it is and one
+//              where it is not, each weighed by its probability given
+//              what was found so far. A game therefore covers all the
+//              worlds that agree on what it found, and the games share
+//              every step until they split.
+//
+// NOTES:       - Usage:
+//
+//                  Evaluator<MyAI> evaluator ( 4 );
+//                  double score = evaluator.evaluate ( 4, 4, seed );
+//
+//              - The agent type is copied wherever a game splits, so it
+//                must be copyable, and its actions must depend only on
+//                its percepts and its seed, as MyAI's do. Its default
+//                constructor makes the agent every game starts from.
+//
+//              - The games are played as World::run plays them, with
+//                the Rules' scoring, and end the same way: by death, by
+//                climbing out, or when the score falls below -1000.
+//
+//              - Boards hold at most 64 tiles, the features of a board
+//                are masks of one bit per tile.
+//
+//              - The first games are split breadth first into a fixed
+//                number of tasks, which are played on the threads. The
+//                tasks do not depend on the number of threads, so the
+//                result is the same for any number of them.
+// ======================================================================
+
+#ifndef EVALUATOR_LOCK
+#define EVALUATOR_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <vector>
+#include "Agent.hpp"
+#include "Parallel.hpp"
+#include "Random.hpp"
+
+template <typename AgentType>
+class Evaluator
+{
+public:
+
+	// Constructor, plays the tasks on numOfThreads threads
+	Evaluator ( unsigned _numOfThreads = 1 ) : numOfThreads ( _numOfThreads ), numOfGames ( 0 ) {}
+
+	// The expected score of the agent on random cols x rows worlds, the
+	// agent reset as a World seeded with seed resets it. Throws
+	// std::exception if the board does not hold 1 to 64 tiles.
+	double evaluate ( int cols, int rows, uint64_t seed = 0 )
+	{
+		if ( cols < 1 || rows < 1 || cols * rows > 64 )
+			throw std::exception();
+
+		Game root;
+		root.agent.reset ( Random::deriveSeed ( seed, 1 ) );
+		root.cols       = cols;
+		root.rows       = rows;
+		root.pitKnown   = 1;		// No pit in (0,0)
+		root.pits       = 0;
+		root.notWumpus  = 1;		// Nor the wumpus, nor the gold
+		root.notGold    = 1;
+		root.wumpus     = NOWHERE;
+		root.gold       = NOWHERE;
+		root.wumpusDead = false;
+		root.score      = 0;
+		root.goldLooted = false;
+		root.hasArrow   = true;
+		root.bump       = false;
+		root.scream     = false;
+		root.agentDir   = 0;
+		root.agentX     = 0;
+		root.agentY     = 0;
+		root.acting     = false;
+		root.action     = Agent::CLIMB;
+
+		// Split the first games into tasks, breadth first
+		std::deque<Task> tasks;
+		Task first = { root, 1.0 };
+		tasks.push_back ( first );
+
+		double	expected = 0;
+		numOfGames = 0;
+		while ( !tasks.empty() && tasks.size() < NUM_OF_TASKS )
+		{
+			Task task = tasks.front();
+			tasks.pop_front();
+
+			Hidden hidden;
+			if ( advance ( task.game, hidden ) )
+			{
+				expected += task.probability * task.game.score;
+				++numOfGames;
+				continue;
+			}
+
+			double probability = chance ( task.game, hidden );
+			if ( probability > 0 )
+			{
+				Task found = { task.game, task.probability * probability };
+				reveal ( found.game, hidden, true );
+				tasks.push_back ( found );
+			}
+			if ( probability < 1 )
+			{
+				task.probability *= 1 - probability;
+				reveal ( task.game, hidden, false );
+				tasks.push_back ( task );
+			}
+		}
+
+		// Play the tasks out, and add them up in order
+		std::vector<double> scores ( tasks.size() );
+		std::vector<size_t> games ( tasks.size(), 0 );
+		parallelFor ( tasks.size(), numOfThreads, [&] ( unsigned, size_t index )
+		{
+			scores[index] = explore ( tasks[index].game, games[index] );
+			return true;
+		} );
+
+		for ( size_t index = 0; index < tasks.size(); ++index )
+		{
+			expected   += tasks[index].probability * scores[index];
+			numOfGames += games[index];
+		}
+		return expected;
+	}
+
+	// Distinct games the latest evaluate played
+	size_t	getNumOfGames	( void ) const { return numOfGames; }
+
+private:
+
+	static const size_t	NUM_OF_TASKS = 256;	// Tasks the first games are split into
+	static const int	NOWHERE      = -1;	// Where a feature is until it is found
+
+	// A game, with what it found of the world so far, tile (c, r) is bit
+	// c*rows + r of the masks
+	struct Game
+	{
+		AgentType	agent;
+
+		// Board Variables
+		int			cols;
+		int			rows;
+		uint64_t	pitKnown;		// Tiles known to hold a pit or not
+		uint64_t	pits;			// Tiles known to hold a pit
+		uint64_t	notWumpus;		// Tiles known not to hold the wumpus
+		uint64_t	notGold;		// Tiles known not to hold the gold
+		int			wumpus;			// The wumpus' tile, NOWHERE until found
+		int			gold;			// The gold's tile, NOWHERE until found
+		bool		wumpusDead;
+
+		// Agent Variables, as in GameState
+		int			score;
+		bool		goldLooted;
+		bool		hasArrow;
+		bool		bump;
+		bool		scream;
+		int			agentDir;		// 0 - right, 1 - down, 2 - left, 3 - up
+		int			agentX;
+		int			agentY;
+
+		// The agent chose action, which is not made yet
+		bool			acting;
+		Agent::Action	action;
+	};
+
+	// A feature of a tile that a game needs and has not found
+	enum Feature { PIT, WUMPUS, GOLD };
+	struct Hidden
+	{
+		Feature	feature;
+		int		tile;
+	};
+
+	struct Task
+	{
+		Game	game;
+		double	probability;	// Of the worlds the game covers
+	};
+
+	unsigned	numOfThreads;
+	size_t		numOfGames;		// Distinct games the latest evaluate played
+
+	// ===============================================================
+	// =					Game Functions
+	// ===============================================================
+
+	// The expected score of the worlds game covers, counting its games
+	double explore ( Game &game, size_t &games )
+	{
+		Hidden hidden;
+		while ( !advance ( game, hidden ) )
+		{
+			double probability = chance ( game, hidden );
+			if ( probability <= 0 || probability >= 1 )
+			{
+				reveal ( game, hidden, probability >= 1 );
+				continue;
+			}
+
+			Game found = game;
+			reveal ( found, hidden, true );
+			reveal ( game, hidden, false );
+			return probability * explore ( found, games ) + ( 1 - probability ) * explore ( game, games );
+		}
+
+		++games;
+		return game.score;
+	}
+
+	// Plays game on until it ends, returning true, or needs a feature it
+	// has not found, returning false with the feature in hidden
+	bool advance ( Game &game, Hidden &hidden )
+	{
+		while ( true )
+		{
+			if ( !game.acting )
+			{
+				int stench  = stenchAt ( game, hidden );
+				int breeze  = stench < 0 ? -1 : breezeAt ( game, hidden );
+				int glitter = breeze < 0 ? -1 : ( game.goldLooted ? 0 : goldAt ( game, tileOf ( game, game.agentX, game.agentY ), hidden ) );
+				if ( glitter < 0 )
+					return false;
+
+				game.action = game.agent.getAction ( stench, breeze, glitter, game.bump, game.scream );
+				game.acting = true;
+			}
+
+			int over = act ( game, hidden );
+			if ( over < 0 )
+				return false;
+
+			game.acting = false;
+			if ( over || game.score < -1000 )
+				return true;
+		}
+	}
+
+	// Makes game's action by the Rules, returning 1 if it ended the game,
+	// 0 if not, or -1 if it needs a feature, before changing anything
+	int act ( Game &game, Hidden &hidden )
+	{
+		const int stepX[4] = { 1, 0, -1, 0 };
+		const int stepY[4] = { 0, -1, 0, 1 };
+
+		int x = game.agentX;
+		int y = game.agentY;
+		int dir = game.agentDir;
+		int died = 0;
+		int hit = 0;
+		int found = 0;
+
+		// Find out what the action meets first
+		if ( game.action == Agent::FORWARD )
+		{
+			if ( isInBounds ( game, x + stepX[dir], y + stepY[dir] ) )
+			{
+				x += stepX[dir];
+				y += stepY[dir];
+			}
+
+			died = pitAt ( game, tileOf ( game, x, y ), hidden );
+			if ( died == 0 && !game.wumpusDead )
+				died = wumpusAt ( game, tileOf ( game, x, y ), hidden );
+			if ( died < 0 )
+				return -1;
+		}
+		else if ( game.action == Agent::SHOOT && game.hasArrow && !game.wumpusDead )
+		{
+			for ( int c = x, r = y; isInBounds ( game, c, r ) && hit == 0; c += stepX[dir], r += stepY[dir] )
+				hit = wumpusAt ( game, tileOf ( game, c, r ), hidden );
+			if ( hit < 0 )
+				return -1;
+		}
+		else if ( game.action == Agent::GRAB && !game.goldLooted )
+		{
+			found = goldAt ( game, tileOf ( game, x, y ), hidden );
+			if ( found < 0 )
+				return -1;
+		}
+
+		// Then make it, as Rules::step does
+		--game.score;
+		game.bump   = false;
+		game.scream = false;
+
+		switch ( game.action )
+		{
+			case Agent::TURN_LEFT:
+				game.agentDir = ( dir + 3 ) % 4;
+				break;
+
+			case Agent::TURN_RIGHT:
+				game.agentDir = ( dir + 1 ) % 4;
+				break;
+
+			case Agent::FORWARD:
+				game.bump   = x == game.agentX && y == game.agentY;
+				game.agentX = x;
+				game.agentY = y;
+				if ( died )
+				{
+					game.score -= 1000;
+					return 1;
+				}
+				break;
+
+			case Agent::SHOOT:
+				if ( game.hasArrow )
+				{
+					game.hasArrow = false;
+					game.score -= 10;
+					if ( hit )
+					{
+						game.wumpusDead = true;
+						game.scream     = true;
+					}
+				}
+				break;
+
+			case Agent::GRAB:
+				if ( found )
+					game.goldLooted = true;
+				break;
+
+			case Agent::CLIMB:
+				if ( x == 0 && y == 0 )
+				{
+					if ( game.goldLooted )
+						game.score += 1000;
+					return 1;
+				}
+				break;
+		}
+		return 0;
+	}
+
+	// ===============================================================
+	// =					World Functions
+	// ===============================================================
+
+	// Percepts of the agent's tile, 1 or 0, or -1 if a feature is needed;
+	// a dead wumpus leaves its stench in its tile and around it
+	int stenchAt ( Game &game, Hidden &hidden )
+	{
+		if ( game.wumpusDead && game.wumpus == tileOf ( game, game.agentX, game.agentY ) )
+			return 1;
+		return anyAround ( game, WUMPUS, hidden );
+	}
+
+	int breezeAt ( Game &game, Hidden &hidden )
+	{
+		return anyAround ( game, PIT, hidden );
+	}
+
+	// 1 if any tile next to the agent holds feature, 0 if none, or -1 if
+	// a feature is needed
+	int anyAround ( Game &game, Feature feature, Hidden &hidden )
+	{
+		const int stepX[4] = { 1, 0, -1, 0 };
+		const int stepY[4] = { 0, -1, 0, 1 };
+
+		for ( int dir = 0; dir < 4; ++dir )
+		{
+			int c = game.agentX + stepX[dir];
+			int r = game.agentY + stepY[dir];
+			if ( !isInBounds ( game, c, r ) )
+				continue;
+
+			int tile = tileOf ( game, c, r );
+			int there = feature == PIT ? pitAt ( game, tile, hidden ) : wumpusAt ( game, tile, hidden );
+			if ( there != 0 )
+				return there;
+		}
+		return 0;
+	}
+
+	// 1 if tile holds the feature, 0 if not, or -1 if it is not found yet
+	int pitAt ( const Game &game, int tile, Hidden &hidden )
+	{
+		if ( game.pitKnown >> tile & 1 )
+			return game.pits >> tile & 1;
+		return need ( PIT, tile, hidden );
+	}
+
+	int wumpusAt ( const Game &game, int tile, Hidden &hidden )
+	{
+		if ( game.wumpus != NOWHERE || ( game.notWumpus >> tile & 1 ) )
+			return game.wumpus == tile;
+		return need ( WUMPUS, tile, hidden );
+	}
+
+	int goldAt ( const Game &game, int tile, Hidden &hidden )
+	{
+		if ( game.gold != NOWHERE || ( game.notGold >> tile & 1 ) )
+			return game.gold == tile;
+		return need ( GOLD, tile, hidden );
+	}
+
+	int need ( Feature feature, int tile, Hidden &hidden )
+	{
+		hidden.feature = feature;
+		hidden.tile    = tile;
+		return -1;
+	}
+
+	// The probability that the hidden feature is there, given what game
+	// found so far: pits are independent, the wumpus and the gold are in
+	// any of the tiles not ruled out yet
+	double chance ( const Game &game, const Hidden &hidden )
+	{
+		if ( hidden.feature == PIT )
+			return 0.2;
+
+		uint64_t ruledOut = hidden.feature == WUMPUS ? game.notWumpus : game.notGold;
+		return 1.0 / ( game.cols * game.rows - popCount ( ruledOut ) );
+	}
+
+	// Records whether the hidden feature is there
+	void reveal ( Game &game, const Hidden &hidden, bool there )
+	{
+		uint64_t bit = 1ULL << hidden.tile;
+		switch ( hidden.feature )
+		{
+			case PIT:
+				game.pitKnown |= bit;
+				if ( there )
+					game.pits |= bit;
+				break;
+
+			case WUMPUS:
+				if ( there )
+					game.wumpus = hidden.tile;
+				else
+					game.notWumpus |= bit;
+				break;
+
+			case GOLD:
+				if ( there )
+					game.gold = hidden.tile;
+				else
+					game.notGold |= bit;
+				break;
+		}
+	}
+
+	// ===============================================================
+	// =					Helper Functions
+	// ===============================================================
+
+	static bool isInBounds ( const Game &game, int c, int r )
+	{
+		return c >= 0 && c < game.cols && r >= 0 && r < game.rows;
+	}
+
+	static int tileOf ( const Game &game, int c, int r )
+	{
+		return c * game.rows + r;
+	}
+
+	static int popCount ( uint64_t bits )
+	{
+		int count = 0;
+		for ( ; bits; bits &= bits - 1 )
+			++count;
+		return count;
+	}
+};
+
+#endif /* EVALUATOR_LOCK */
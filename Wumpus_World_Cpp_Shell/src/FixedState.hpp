@@ -0,0 +1,138 @@
+// ======================================================================
+// FILE:        FixedState.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the fixed state of a game, a GameState
+//              whose board size is a template parameter, and the
+//              dispatch that plays a GameState on the fixed state of its
+//              size. The Rules are templates over the state, so on a
+//              fixed state every bounds check and tile index is worked
+//              out against constants, and the board is an array inside
+//              the struct.
+//
+// NOTES:       - Fixed states exist for boards of 4 to 8 columns and 4
+//                to 8 rows, every size of the corpus and the benchmark.
+//                Any other board is played on the GameState.
+//
+//              - Only the engine is specialized. An agent must not know
+//                the size of the board before bumping into its walls.
+// ======================================================================
+
+#ifndef FIXEDSTATE_LOCK
+#define FIXEDSTATE_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "GameState.hpp"
+#include "Rules.hpp"
+
+template <size_t COLS, size_t ROWS>
+struct FixedState
+{
+	// Board Variables, as in GameState
+	static const size_t	colDimension = COLS;
+	static const size_t	rowDimension = ROWS;
+	uint8_t	board[COLS * ROWS];	// One byte of Rules::TileFlags per tile, column after column
+
+	// Agent Variables, as in GameState
+	int		score;
+	bool	goldLooted;
+	bool	hasArrow;
+	bool	bump;
+	bool	scream;
+	size_t	agentDir;			// 0 - right, 1 - down, 2 - left, 3 - up
+	size_t	agentX;
+	size_t	agentY;
+
+	uint8_t&	tile	( size_t c, size_t r )       { return board[c * ROWS + r]; }
+	uint8_t		tile	( size_t c, size_t r ) const { return board[c * ROWS + r]; }
+
+	// Copies a GameState of this size in, or back out
+	void load ( const GameState &state )
+	{
+		memcpy ( board, state.board.data(), sizeof(board) );
+		score      = state.score;
+		goldLooted = state.goldLooted;
+		hasArrow   = state.hasArrow;
+		bump       = state.bump;
+		scream     = state.scream;
+		agentDir   = state.agentDir;
+		agentX     = state.agentX;
+		agentY     = state.agentY;
+	}
+
+	void store ( GameState &state ) const
+	{
+		memcpy ( state.board.data(), board, sizeof(board) );
+		state.score      = score;
+		state.goldLooted = goldLooted;
+		state.hasArrow   = hasArrow;
+		state.bump       = bump;
+		state.scream     = scream;
+		state.agentDir   = agentDir;
+		state.agentX     = agentX;
+		state.agentY     = agentY;
+	}
+
+	// Percepts of the agent's tile
+	bool	stench	( void ) const { return tile ( agentX, agentY ) & Rules::STENCH; }
+	bool	breeze	( void ) const { return tile ( agentX, agentY ) & Rules::BREEZE; }
+	bool	glitter	( void ) const { return tile ( agentX, agentY ) & Rules::GOLD; }
+};
+
+template <size_t COLS, size_t ROWS> const size_t FixedState<COLS, ROWS>::colDimension;
+template <size_t COLS, size_t ROWS> const size_t FixedState<COLS, ROWS>::rowDimension;
+
+// ===============================================================
+// =					Dispatch Functions
+// ===============================================================
+
+// Plays state on the fixed state of its size, play is any object with a
+// template operator() taking a state and returning an int:
+//
+//     struct Play { template <typename State> int operator() ( State &state ); };
+//
+// The fixed state is loaded from state before and stored back after, so
+// state holds the game as play left it. Boards with no fixed state are
+// played on state itself. Returns what play returns.
+template <size_t COLS, size_t ROWS, typename Play>
+int playFixed ( GameState &state, Play &play )
+{
+	FixedState<COLS, ROWS> fixed;
+	fixed.load ( state );
+	int result = play ( fixed );
+	fixed.store ( state );
+	return result;
+}
+
+template <size_t COLS, typename Play>
+int playFixedColumns ( GameState &state, Play &play )
+{
+	switch ( state.rowDimension )
+	{
+		case 4: return playFixed<COLS, 4> ( state, play );
+		case 5: return playFixed<COLS, 5> ( state, play );
+		case 6: return playFixed<COLS, 6> ( state, play );
+		case 7: return playFixed<COLS, 7> ( state, play );
+		case 8: return playFixed<COLS, 8> ( state, play );
+		default: return play ( state );
+	}
+}
+
+template <typename Play>
+int playOnFixedState ( GameState &state, Play &play )
+{
+	switch ( state.colDimension )
+	{
+		case 4: return playFixedColumns<4> ( state, play );
+		case 5: return playFixedColumns<5> ( state, play );
+		case 6: return playFixedColumns<6> ( state, play );
+		case 7: return playFixedColumns<7> ( state, play );
+		case 8: return playFixedColumns<8> ( state, play );
+		default: return play ( state );
+	}
+}
+
+#endif /* FIXEDSTATE_LOCK */
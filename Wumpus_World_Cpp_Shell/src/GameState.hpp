@@ -0,0 +1,73 @@
+// ======================================================================
+// FILE:        GameState.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the state of a game, everything the
+//              Rules play on: the board and the agent's position,
+//              direction, arrow and score. It is a value, a copy is a
+//              snapshot of the game that can be stepped on its own, so a
+//              game can be forked for a lookahead or saved and restored
+//              in the middle, without the World or its file.
+//
+// NOTES:       - Copying into a state of the same board size reuses its
+//                memory, so forks of one game allocate only once.
+//
+//              - The agent itself is not part of the state, whatever it
+//                remembers has to be copied with it separately.
+// ======================================================================
+
+#ifndef GAMESTATE_LOCK
+#define GAMESTATE_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Rules.hpp"
+#include "WorldSpec.hpp"
+
+struct GameState
+{
+	// Board Variables
+	size_t	colDimension;			// The number of columns the game board has
+	size_t	rowDimension;			// The number of rows the game board has
+	std::vector<uint8_t>	board;	// One byte of Rules::TileFlags per tile, column after column
+
+	// Agent Variables
+	int		score;			// The agent's score
+	bool	goldLooted;		// True if gold was successfuly looted
+	bool	hasArrow;		// True if the agent can shoot
+	bool	bump;			// Bump percept flag
+	bool	scream;			// Scream percept flag
+	size_t	agentDir;		// The direction the agent is facing: 0 - right, 1 - down, 2 - left, 3 - up
+	size_t	agentX;			// The column where the agent is located ( x-coord = col-coord )
+	size_t	agentY;			// The row where the agent is located ( y-coord = row-coord )
+
+	GameState ( void ) : colDimension ( 0 ), rowDimension ( 0 ) { Rules::resetAgent ( *this ); }
+
+	uint8_t&	tile	( size_t c, size_t r )       { return board[c * rowDimension + r]; }
+	uint8_t		tile	( size_t c, size_t r ) const { return board[c * rowDimension + r]; }
+
+	// Empties the board, keeping its memory, and puts the agent at (0,0)
+	void clear ( size_t cols, size_t rows )
+	{
+		colDimension = cols;
+		rowDimension = rows;
+		board.assign ( cols * rows, 0 );
+		Rules::resetAgent ( *this );
+	}
+
+	// Starts a new game on spec
+	void reset ( const WorldSpec &spec )
+	{
+		clear ( spec.colDimension, spec.rowDimension );
+		Rules::addFeatures ( *this, spec );
+	}
+
+	// Percepts of the agent's tile
+	bool	stench	( void ) const { return tile ( agentX, agentY ) & Rules::STENCH; }
+	bool	breeze	( void ) const { return tile ( agentX, agentY ) & Rules::BREEZE; }
+	bool	glitter	( void ) const { return tile ( agentX, agentY ) & Rules::GOLD; }
+};
+
+#endif /* GAMESTATE_LOCK */
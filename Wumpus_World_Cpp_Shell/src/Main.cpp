@@ -17,6 +17,13 @@
 //                  Options:
 //						-m Use the ManualAI instead of MyAI.
 //						-r Use the RandomAI instead of MyAI.
+//                      -a[N] Use the SearchAI instead of MyAI: MyAI
+//                         that weighs its risky moves by N milliseconds
+//                         of sampled games per decision, 10 if N is
+//                         omitted. Results then depend on the machine.
+//                         It has not measurably beaten MyAI.
+//                      -kN runs the sampled games of -a on N threads,
+//                         or on one thread per core if N is 0.
 //                      -d Debug mode, which displays the game board
 //                         after every mode. Useless with -m.
 //                      -h Displays help menu and quits.
@@ -26,37 +33,139 @@
 //                         worlds. This will trigger the program to
 //                         display the average score and standard
 //                         deviation instead of a single score. InputFile
-//                         must be entered with this option.
+//                         must be entered with this option. InputFile
+//                         may also be a corpus file made with -p.
+//                      -p packs the worlds of the folder InputFile into
+//                         the corpus file OutputFile and quits. Playing
+//                         the corpus gives the same result as playing
+//                         the folder.
+//                      -gN plays N random worlds of 4x4 to 7x7 and
+//                         displays the average score and standard
+//                         deviation, like -f. The worlds are generated
+//                         while the games are played, and never written
+//                         to disk. No InputFile is used; the first file
+//                         given is the OutputFile.
+//                      -j[N] plays the worlds of -f or -g on N threads,
+//                         or on one thread per core if N is omitted. The
+//                         result is the same for any N.
+//                      -sN seeds the random numbers with N, so a game
+//                         can be replayed. Without it the current time
+//                         is used. In folder mode the i-th world is
+//                         played with seed N+i. With -g the i-th world
+//                         is also generated from seed N+i.
+//                      -t writes the trace of every game lost, by death
+//                         or by running out of score, to OutputFile,
+//                         and displays the results instead.
+//                      -e[N] replays the trace file InputFile made with
+//                         -t, checking that every game still plays as
+//                         recorded, and displays the average score.
+//                         With N, also displays each game after its
+//                         N-th step; add -d to step on from there.
+//                      -x[N] works out MyAI's exact expected score on
+//                         the random worlds of -g, for every size of at
+//                         most N tiles, 25 if N is omitted, by playing
+//                         each distinct game once, weighed by its
+//                         probability. With N of 49 or more it also
+//                         displays the expected score over all sizes,
+//                         which -g estimates. No InputFile is used.
+//                      -c[N] compares the agent with a baseline on the
+//                         worlds of -f or -g: MyAI, or the SearchAI of
+//                         -a with N milliseconds if N is given. Both
+//                         play every world with the same seed, and the
+//                         program displays the mean of the agent's score
+//                         minus the baseline's with its 95% confidence
+//                         interval. The worlds are played 100, 200, 400,
+//                         ... at a time, and the comparison stops as
+//                         soon as the interval leaves out 0. Only agents
+//                         built into this program can be compared, not
+//                         two builds of one agent.
 //
 //                  InputFile: A path to a valid Wumpus World File, or
-//                             folder with -f. This is optional unless
-//                             used with -f or OutputFile.
+//                             folder or corpus with -f, or trace file
+//                             with -e. This is optional unless used
+//                             with -f, -p, -e or OutputFile.
 //
 //                  OutputFile: A path to a file where the results will
 //                              be written. This is optional.
 //
 //              - If -m and -r are turned on, -m will be turned off.
 //
+//              - Numeric option values follow their letter directly,
+//                e.g. -fj8.
+//
 //              - Don't make changes to this file.
 // ======================================================================
  
 #include <iostream>
 #include <ctime>
 #include <dirent.h>
+#include <fstream>
+#include <sys/stat.h>
 #include <cmath>
+#include <cctype>
+#include <thread>
+#include <vector>
 #include "World.hpp"
+#include "Tournament.hpp"
+#include "Corpus.hpp"
+#include "SearchAI.hpp"
+#include "Trace.hpp"
+#include "ReplayAI.hpp"
+#include "Evaluator.hpp"
 
 using namespace std;
 
+// Collects the names of the world files in folder, returns false if it cannot be opened
+bool listWorlds ( const string &folder, vector<string> &worldNames )
+{
+	DIR *dir;
+	if ( ( dir = opendir (folder.c_str()) ) == NULL )
+		return false;
+	
+	struct dirent *ent;
+	while ( ( ent = readdir (dir) ) != NULL )
+	{
+		if ( ent->d_name[0] == '.' )
+			continue;
+		
+		worldNames.push_back ( ent->d_name );
+	}
+	
+	closedir (dir);
+	return true;
+}
+
+// Plays world, and writes the trace of the game to traceFile if it is open and the game is lost
+int playWorld ( World &world, ofstream &traceFile )
+{
+	Trace trace;
+	if ( traceFile.is_open() )
+		world.setTrace ( &trace );
+	
+	int score = world.run();
+	if ( traceFile.is_open() && score < -1000 )
+	{
+		try
+		{
+			trace.write ( traceFile );
+		}
+		catch ( const std::exception& e )
+		{
+			cout << "[ERROR] Failure to write trace file." << endl;
+		}
+	}
+	return score;
+}
+
 int main ( int argc, char *argv[] )
 {
-	// Set random seed
-	srand( time ( NULL ) );
+	// Default random seed
+	uint64_t seed = time ( NULL );
 	
 	if ( argc == 1 )
 	{
 		// Run on a random world and exit
-		World world;
+		World world ( false, false, false, "", seed );
 		int score = world.run();
 		cout << "Your agent scored: " << score << endl;
 		return 0;
@@ -67,7 +176,19 @@ int main ( int argc, char *argv[] )
 	bool	verbose      = false;
 	bool 	randomAI     = false;
 	bool 	manualAI      = false;
+	bool	searchAI     = false;
 	bool 	folder       = false;
+	bool	pack         = false;
+	bool	traceLosses  = false;
+	bool	replay       = false;
+	bool	seeking      = false;
+	size_t	seekStep     = 0;
+	bool	exact        = false;
+	int		maxTiles     = 25;
+	bool	compare      = false;
+	int		baselineMs   = -1;
+	unsigned numOfThreads = 1;
+	size_t	numOfGenerated = 0;
 	string	worldFile    = "";
 	string	outputFile   = "";
 	string 	firstToken 	 = argv[1];
@@ -93,6 +214,76 @@ int main ( int argc, char *argv[] )
 					verbose = true;
 					break;
 					
+				case 'p':
+				case 'P':
+					pack = true;
+					break;
+					
+				case 'g':
+				case 'G':
+					numOfGenerated = 0;
+					while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+						numOfGenerated = numOfGenerated*10 + ( firstToken[++index] - '0' );
+					if ( numOfGenerated == 0 )
+					{
+						cout << "[ERROR] -g needs the number of worlds, e.g. -g100000." << endl;
+						return 0;
+					}
+					break;
+					
+				case 't':
+				case 'T':
+					traceLosses = true;
+					break;
+					
+				case 'e':
+				case 'E':
+					replay = true;
+					seeking = index+1 < firstToken.size() && isdigit ( firstToken[index+1] );
+					seekStep = 0;
+					while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+						seekStep = seekStep*10 + ( firstToken[++index] - '0' );
+					break;
+					
+				case 'x':
+				case 'X':
+					exact = true;
+					if ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+					{
+						maxTiles = 0;
+						while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+							maxTiles = maxTiles*10 + ( firstToken[++index] - '0' );
+					}
+					break;
+					
+				case 'c':
+				case 'C':
+					compare = true;
+					baselineMs = -1;
+					if ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+					{
+						baselineMs = 0;
+						while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+							baselineMs = baselineMs*10 + ( firstToken[++index] - '0' );
+					}
+					break;
+					
+				case 'j':
+				case 'J':
+					numOfThreads = 0;
+					while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+						numOfThreads = numOfThreads*10 + ( firstToken[++index] - '0' );
+					if ( numOfThreads == 0 )
+						numOfThreads = thread::hardware_concurrency();
+					break;
+					
+				case 's':
+				case 'S':
+					seed = 0;
+					while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+						seed = seed*10 + ( firstToken[++index] - '0' );
+					break;
+					
 				case 'r':
 				case 'R':
 					randomAI = true;
@@ -103,6 +294,26 @@ int main ( int argc, char *argv[] )
 					manualAI = true;
 					break;
 					
+				case 'a':
+				case 'A':
+					searchAI = true;
+					if ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+					{
+						SearchAI::budgetMs = 0;
+						while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+							SearchAI::budgetMs = SearchAI::budgetMs*10 + ( firstToken[++index] - '0' );
+					}
+					break;
+					
+				case 'k':
+				case 'K':
+					SearchAI::numOfThreads = 0;
+					while ( index+1 < firstToken.size() && isdigit ( firstToken[index+1] ) )
+						SearchAI::numOfThreads = SearchAI::numOfThreads*10 + ( firstToken[++index] - '0' );
+					if ( SearchAI::numOfThreads == 0 )
+						SearchAI::numOfThreads = thread::hardware_concurrency();
+					break;
+					
 				case 'd':
 				case 'D':
 					debug = true;
@@ -116,6 +327,13 @@ int main ( int argc, char *argv[] )
 					cout << "Options:" << endl;
 					cout << "\t-m Use the ManualAI instead of MyAI." << endl;
 					cout << "\t-r Use the RandomAI instead of MyAI." << endl;
+					cout << "\t-a[N] Use the SearchAI instead of MyAI: MyAI" << endl;
+					cout << "\t   that weighs its risky moves by N milliseconds" << endl;
+					cout << "\t   of sampled games per decision, 10 if N is" << endl;
+					cout << "\t   omitted. Results then depend on the machine." << endl;
+					cout << "\t   It has not measurably beaten MyAI." << endl;
+					cout << "\t-kN runs the sampled games of -a on N threads," << endl;
+					cout << "\t   or on one thread per core if N is 0." << endl;
 					cout << "\t-d Debug mode, which displays the game board" << endl;
 					cout << "\t   after every mode. Useless with -m." << endl;
 					cout << "\t-h Displays help menu and quits." << endl;
@@ -125,11 +343,57 @@ int main ( int argc, char *argv[] )
 					cout << "\t   worlds. This will trigger the program to" << endl;
 					cout << "\t   display the average score and standard" << endl;
 					cout << "\t   deviation instead of a single score. InputFile" << endl;
-					cout << "\t   must be entered with this option." << endl;
+					cout << "\t   must be entered with this option. InputFile" << endl;
+					cout << "\t   may also be a corpus file made with -p." << endl;
+					cout << "\t-p packs the worlds of the folder InputFile into" << endl;
+					cout << "\t   the corpus file OutputFile and quits. Playing" << endl;
+					cout << "\t   the corpus gives the same result as playing" << endl;
+					cout << "\t   the folder." << endl;
+					cout << "\t-gN plays N random worlds of 4x4 to 7x7 and" << endl;
+					cout << "\t   displays the average score and standard" << endl;
+					cout << "\t   deviation, like -f. The worlds are generated" << endl;
+					cout << "\t   while the games are played, and never written" << endl;
+					cout << "\t   to disk. No InputFile is used; the first file" << endl;
+					cout << "\t   given is the OutputFile." << endl;
+					cout << "\t-j[N] plays the worlds of -f or -g on N threads," << endl;
+					cout << "\t   or on one thread per core if N is omitted. The" << endl;
+					cout << "\t   result is the same for any N." << endl;
+					cout << "\t-sN seeds the random numbers with N, so a game" << endl;
+					cout << "\t   can be replayed. Without it the current time" << endl;
+					cout << "\t   is used. In folder mode the i-th world is" << endl;
+					cout << "\t   played with seed N+i. With -g the i-th world" << endl;
+					cout << "\t   is also generated from seed N+i." << endl;
+					cout << "\t-t writes the trace of every game lost, by death" << endl;
+					cout << "\t   or by running out of score, to OutputFile," << endl;
+					cout << "\t   and displays the results instead." << endl;
+					cout << "\t-e[N] replays the trace file InputFile made with" << endl;
+					cout << "\t   -t, checking that every game still plays as" << endl;
+					cout << "\t   recorded, and displays the average score." << endl;
+					cout << "\t   With N, also displays each game after its" << endl;
+					cout << "\t   N-th step; add -d to step on from there." << endl;
+					cout << "\t-x[N] works out MyAI's exact expected score on" << endl;
+					cout << "\t   the random worlds of -g, for every size of at" << endl;
+					cout << "\t   most N tiles, 25 if N is omitted, by playing" << endl;
+					cout << "\t   each distinct game once, weighed by its" << endl;
+					cout << "\t   probability. With N of 49 or more it also" << endl;
+					cout << "\t   displays the expected score over all sizes," << endl;
+					cout << "\t   which -g estimates. No InputFile is used." << endl;
+					cout << "\t-c[N] compares the agent with a baseline on the" << endl;
+					cout << "\t   worlds of -f or -g: MyAI, or the SearchAI of" << endl;
+					cout << "\t   -a with N milliseconds if N is given. Both" << endl;
+					cout << "\t   play every world with the same seed, and the" << endl;
+					cout << "\t   program displays the mean of the agent's score" << endl;
+					cout << "\t   minus the baseline's with its 95% confidence" << endl;
+					cout << "\t   interval. The worlds are played 100, 200, 400," << endl;
+					cout << "\t   ... at a time, and the comparison stops as" << endl;
+					cout << "\t   soon as the interval leaves out 0. Only agents" << endl;
+					cout << "\t   built into this program can be compared, not" << endl;
+					cout << "\t   two builds of one agent." << endl;
 					cout << endl;
 					cout << "InputFile: A path to a valid Wumpus World File, or" << endl;
-					cout << "           folder with -f. This is optional unless" << endl;
-					cout << "           used with -f." << endl;
+					cout << "           folder or corpus with -f, or trace file" << endl;
+					cout << "           with -e. This is optional unless used" << endl;
+					cout << "           with -f, -p, -e or OutputFile." << endl;
 					cout << endl;
 					cout << "OutputFile: A path to a file where the results will" << endl;
 					cout << "            be written. This is optional." << endl;
@@ -145,10 +409,18 @@ int main ( int argc, char *argv[] )
 			cout << "[WARNING] Manual AI and Random AI both on; Manual AI was turned off." << endl;
 		}
 		
-		if ( argc >= 3 )
-			worldFile = argv[2];
-		if ( argc >= 4 )
-			outputFile = argv[3];
+		if ( numOfGenerated > 0 )
+		{
+			if ( argc >= 3 )
+				outputFile = argv[2];
+		}
+		else
+		{
+			if ( argc >= 3 )
+				worldFile = argv[2];
+			if ( argc >= 4 )
+				outputFile = argv[3];
+		}
 	}
 	else
 	{
@@ -158,69 +430,267 @@ int main ( int argc, char *argv[] )
 			outputFile = argv[2];
 	}
 	
-	if ( worldFile == "" )
+	// With -t the OutputFile receives the traces, and the results are displayed
+	ofstream traceFile;
+	if ( traceLosses && !pack && !replay )
 	{
-		if ( folder )
-			cout << "[WARNING] No folder specified; running on a random world." << endl;
-		World world ( debug, randomAI, manualAI );
-		int score = world.run();
-		cout << "The agent scored: " << score << endl;
-		return 0;
+		if ( outputFile == "" )
+		{
+			cout << "[ERROR] -t needs an OutputFile for the traces." << endl;
+			return 0;
+		}
+		
+		try
+		{
+			traceFile.open ( outputFile, ios::binary );
+			Trace::writeHeader ( traceFile );
+		}
+		catch ( const std::exception& e )
+		{
+			cout << "[ERROR] Failure to open trace file." << endl;
+			return 0;
+		}
+		outputFile = "";
 	}
 	
-	if ( folder )
+	if ( pack )
 	{
-		DIR *dir;
-		if ( ( dir = opendir (worldFile.c_str()) ) == NULL )
+		vector<string> worldNames;
+		if ( worldFile == "" || outputFile == "" || !listWorlds ( worldFile, worldNames ) )
 		{
-			cout << "[ERROR] Failed to open directory." << endl;
+			cout << "[ERROR] -p needs a world folder and a corpus file." << endl;
 			return 0;
 		}
 		
-		struct dirent *ent;
+		vector<WorldSpec> specs ( worldNames.size() );
+		for ( size_t index = 0; index < worldNames.size(); ++index )
+		{
+			try
+			{
+				specs[index].read ( "./" + worldFile + "/" + worldNames[index] );
+			}
+			catch ( const std::exception& e )
+			{
+				cout << "[ERROR] Failure to open file: " << worldNames[index] << endl;
+				return 0;
+			}
+		}
 		
-		int		numOfScores        = 0;
-		double	sumOfScores        = 0;
-		double	sumOfScoresSquared = 0;
+		try
+		{
+			Corpus::write ( outputFile, specs );
+		}
+		catch ( const std::exception& e )
+		{
+			cout << "[ERROR] Failure to write corpus; boards must be at most 8x8, with the wumpus and the gold on them." << endl;
+			return 0;
+		}
 		
-		while ( ( ent = readdir (dir) ) != NULL )
+		if ( verbose )
+			cout << "Packed " << specs.size() << " worlds into " << outputFile << endl;
+		return 0;
+	}
+	
+	if ( replay )
+	{
+		ifstream	file ( worldFile, ios::binary );
+		Trace		trace;
+		GameState	state;
+		ReplayAI	replayAI;
+		int			numOfTraces = 0;
+		double		sumOfScores = 0;
+		
+		try
+		{
+			Trace::readHeader ( file );
+		}
+		catch ( const std::exception& e )
+		{
+			cout << "[ERROR] Failure to open trace file." << endl;
+			return 0;
+		}
+		
+		while ( true )
 		{
-			if ( ent->d_name[0] == '.' )
-				continue;
+			try
+			{
+				if ( !trace.read ( file ) )
+					break;
+			}
+			catch ( const std::exception& e )
+			{
+				cout << "[ERROR] Trace #" << numOfTraces << " is cut short or corrupt." << endl;
+				return 0;
+			}
+			
+			// Every game is replayed to the end first, so a seek only shows games that match
+			try
+			{
+				trace.seek ( state, trace.size() );
+				if ( seeking )
+					trace.seek ( state, seekStep );
+			}
+			catch ( const std::exception& e )
+			{
+				cout << "[ERROR] Trace #" << numOfTraces << " no longer plays as recorded." << endl;
+				return 0;
+			}
 			
 			if ( verbose )
-				cout << "Running world: " << ent->d_name << endl;
+				cout << "Replayed trace #" << numOfTraces << ", seed: " << trace.getSeed() << ", steps: "
+					 << trace.size() << ", score: " << trace.getScore() << endl;
 			
-			string individualWorldFile = "./" + worldFile + "/" + ent->d_name;
+			if ( seeking )
+			{
+				size_t step = seekStep < trace.size() ? seekStep : trace.size();
+				cout << "Trace #" << numOfTraces << ", seed: " << trace.getSeed() << ", step "
+					 << step << " of " << trace.size() << ":" << endl;
+				
+				World world ( &replayAI, debug );
+				replayAI.start ( &trace, step );
+				world.restore ( state, step > 0 ? trace.getAction ( step-1 ) : Agent::CLIMB );
+				if ( debug && step < trace.size() )
+					world.run();
+				else
+					world.printWorldInfo();
+			}
 			
-			int score;
+			++numOfTraces;
+			sumOfScores += trace.getScore();
+		}
+		
+		cout << "Replayed " << numOfTraces << " games, all as recorded." << endl;
+		if ( numOfTraces > 0 )
+			cout << "The agent's average score: " << sumOfScores / numOfTraces << endl;
+		return 0;
+	}
+	
+	if ( exact )
+	{
+		if ( randomAI || manualAI || searchAI )
+		{
+			cout << "[ERROR] -x works out MyAI's score only." << endl;
+			return 0;
+		}
+		
+		// The sizes -g draws from, all equally likely
+		Evaluator<MyAI>	evaluator ( numOfThreads );
+		double	sumOfScores = 0;
+		int		numOfSizes  = 0;
+		for ( int cols = 4; cols <= 7; ++cols )
+			for ( int rows = 4; rows <= 7; ++rows )
+			{
+				if ( cols * rows > maxTiles )
+					continue;
+				
+				double score = evaluator.evaluate ( cols, rows, seed );
+				cout << cols << "x" << rows << ": " << score << " over "
+					 << evaluator.getNumOfGames() << " distinct games" << endl;
+				sumOfScores += score;
+				++numOfSizes;
+			}
+		
+		if ( numOfSizes == 16 )
+			cout << "The agent's expected score: " << sumOfScores / numOfSizes << endl;
+		return 0;
+	}
+	
+	if ( compare )
+	{
+		// The agent is made as World::newAgent makes it
+		bool sameAgent = randomAI ? false : searchAI ? baselineMs == SearchAI::budgetMs : baselineMs < 0;
+		if ( manualAI || sameAgent )
+		{
+			cout << "[ERROR] -c compares two different agents, e.g. -rc, -ac, or -a20c0." << endl;
+			return 0;
+		}
+		if ( !folder && numOfGenerated == 0 )
+		{
+			cout << "[ERROR] -c needs the worlds of -f or -g." << endl;
+			return 0;
+		}
+	}
+	
+	if ( worldFile == "" && numOfGenerated == 0 )
+	{
+		if ( folder )
+			cout << "[WARNING] No folder specified; running on a random world." << endl;
+		if ( verbose )
+			cout << "Running random world, seed: " << seed << endl;
+		World world ( debug, randomAI, manualAI, "", seed, searchAI );
+		int score = playWorld ( world, traceFile );
+		cout << "The agent scored: " << score << endl;
+		return 0;
+	}
+	
+	if ( folder || numOfGenerated > 0 )
+	{
+		Tournament tournament ( debug, randomAI, manualAI, verbose, numOfThreads, seed, searchAI );
+		if ( traceFile.is_open() )
+			tournament.archiveLosses ( &traceFile );
+		if ( compare && baselineMs < 0 )
+			tournament.compareWith ( [] () { return new MyAI(); }, 0.95 );
+		else if ( compare )
+			tournament.compareWith ( [baselineMs] () { return new SearchAI ( baselineMs ); }, 0.95 );
+		
+		// A regular file is a corpus, anything else a folder of worlds
+		struct stat info;
+		if ( numOfGenerated > 0 )
+			tournament.runGenerated ( numOfGenerated );
+		else if ( stat ( worldFile.c_str(), &info ) == 0 && S_ISREG ( info.st_mode ) )
+		{
+			Corpus corpus;
 			try
 			{
-				World world ( debug, randomAI, manualAI, individualWorldFile );
-				score = world.run();
+				corpus.open ( worldFile );
 			}
-			catch (...)
+			catch ( const std::exception& e )
 			{
-				numOfScores = 0;
-				sumOfScores = 0;
-				sumOfScoresSquared = 0;
-				break;
+				cout << "[ERROR] Failure to open corpus." << endl;
+				return 0;
 			}
-
-			numOfScores += 1;
-			sumOfScores += score;
-			sumOfScoresSquared += score*score;
+			tournament.run ( corpus );
+		}
+		else
+		{
+			vector<string> worldNames;
+			if ( !listWorlds ( worldFile, worldNames ) )
+			{
+				cout << "[ERROR] Failed to open directory." << endl;
+				return 0;
+			}
+			tournament.run ( worldFile, worldNames );
 		}
 		
-		closedir (dir);
+		if ( traceFile.is_open() && traceFile.fail() )
+			cout << "[ERROR] Failure to write trace file." << endl;
+		
+		int		numOfScores        = tournament.getNumOfScores();
+		double	sumOfScores        = tournament.getSumOfScores();
+		double	sumOfScoresSquared = tournament.getSumOfScoresSquared();
 		
 		double avg = (float)sumOfScores / (float)numOfScores;
 		double std_dev = sqrt ( (sumOfScoresSquared - ((sumOfScores*sumOfScores) / (float)numOfScores) ) / (float)numOfScores );
 		
+		const Tournament::Comparison &comparison = tournament.getComparison();
+		
 		if ( outputFile == "" )
 		{
 			cout << "The agent's average score: " << avg << endl;
 			cout << "The agent's standard deviation: " << std_dev << endl;
+			if ( compare )
+			{
+				cout << "The baseline's average score: " << comparison.sumOfBaseline / numOfScores << endl;
+				cout << "The agent minus the baseline: " << comparison.meanDifference << " +- " << comparison.halfWidth
+					 << " over " << numOfScores << " worlds, look " << comparison.numOfLooks << " of "
+					 << comparison.maxLooks << endl;
+				if ( !comparison.decided )
+					cout << "No difference found at 95% confidence." << endl;
+				else if ( comparison.meanDifference > 0 )
+					cout << "The agent beats the baseline at 95% confidence." << endl;
+				else
+					cout << "The baseline beats the agent at 95% confidence." << endl;
+			}
 		}
 		else
 		{
@@ -228,6 +698,12 @@ int main ( int argc, char *argv[] )
 			file.open( outputFile );
 			file << "SCORE: " << avg << endl;
 			file << "STDEV: " << std_dev << endl;
+			if ( compare )
+			{
+				file << "GAMES: " << numOfScores << endl;
+				file << "DIFF: " << comparison.meanDifference << endl;
+				file << "CI: " << comparison.halfWidth << endl;
+			}
 			file.close();
 		}
 		return 0;
@@ -237,10 +713,10 @@ int main ( int argc, char *argv[] )
 	try
 	{
 		if ( verbose )
-			cout << "Running world: " << worldFile << endl;
+			cout << "Running world: " << worldFile << ", seed: " << seed << endl;
 		
-		World world ( debug, randomAI, manualAI, worldFile );
-		int score = world.run();
+		World world ( debug, randomAI, manualAI, worldFile, seed, searchAI );
+		int score = playWorld ( world, traceFile );
 		if ( outputFile == "" )
 		{
 			cout << "The agent scored: " << score << endl;
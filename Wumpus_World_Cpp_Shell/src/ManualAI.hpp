@@ -68,6 +68,10 @@ public:
 
 		return CLIMB;
 	}
+	
+	void reset ( uint64_t seed )
+	{
+	}
 };
 
 #endif
\ No newline at end of file
@@ -21,25 +21,77 @@
 
 // #define DEBUG
 
+// prior probability of a pit in a grid other than (0,0), as in the world generator
+static const double PITPRIOR = 0.2;
+
+// N, E, S, W, indexed by dir%4
+static const int dr[4] = {1, 0, -1, 0};
+static const int dc[4] = {0, 1, 0, -1};
+
 
 /*
  * Constructor
  */
 MyAI::MyAI() : Agent()
 {
-	// initialize the board to its biggest size, all grids have status of 0(unknown)
-	for (int r = 0; r < MAXSIZE; ++r) {
-		grids.push_back(vector<int>(MAXSIZE, 0));
-	}
-	// initialize actual size to MAXSIZE 
-	sizeR = MAXSIZE;
-	sizeC = MAXSIZE;
+	// the store starts at INITIALSIZE x INITIALSIZE and only grows
+	capR = INITIALSIZE;
+	capC = INITIALSIZE;
+	board.assign(capR * capC, Grid());
+	searchQueue.resize(capR * capC * 4);
+	usedR = 0;
+	usedC = 0;
+	searchStamp = 0;
+	markStamp = 0;
+	reset(0);
+}
+
+/*
+ * Restore the initial status
+ */
+void MyAI::reset(uint64_t seed)
+{
+	// all grids are unknown
+	// only the used corner can differ from a new grid
+	for (int r = 0; r < usedR; ++r)
+		for (int c = 0; c < usedC; ++c)
+			at(r, c) = Grid();
+	usedR = 0;
+	usedC = 0;
+	numExplorable = 0;
+	visitedGrids.clear();
+	wumpusGrids.clear();
+	// nothing is known about pits and the wumpus
+	// except that neither is at the entrance
+	breezyGrids.clear();
+	wumpusCandKnown = false;
+	wumpusDead = false;
+	wumpusCandBits = ~gridBit(0, 0);
+	numWumpusCand = 0;
+	// the knowledge starts on the bitboards, with nothing cached
+	onBitboards = true;
+	visited = 0;
+	explorable = 0;
+	unmovable = 0;
+	wumpus = 0;
+	inside = ~0ULL;
+	routable = 0;
+	numRoutable = 0;
+	distCache.clear();
+	cacheStride = 16;
+	memset(freshRows, 0, sizeof(freshRows));
+	// the size is unknown until a wall is found
+	sizeR = INT_MAX;
+	sizeC = INT_MAX;
+	reserveBoard(1, 1);
 	// initial status of agent, at (0,0), facing EAST
 	dir = 1001; // to avoid becoming negative
 	curR = 0;
 	curC = 0;
 	prevR = 0;
 	prevC = 0;
+	// drop the leftover actions
+	qActions.clear();
 	goldFetched = false;
 	wumpusLocked = false;
 	canShoot = true;
@@ -76,8 +128,7 @@ Agent::Action MyAI::getAction
 		printActionQueue(qActions);		
 		#endif
 
-		Agent::Action nextAction = qActions.front();
-		qActions.pop();
+		Agent::Action nextAction = qActions.take();
 		prevAction = nextAction;
 		return nextAction;
 	}
@@ -86,11 +137,10 @@ Agent::Action MyAI::getAction
 		// case2: gold found!
 		if (goldFetched)
 			return GRAB;
-		vector<pair<int, int>> explorable = getExplorable();
 		// case3: no more moves, 
 		// activate SHOOT if agent has ammo and wumpus has been sensed
 		// otherwise return to entrance and escape
-		if (explorable.empty()) {
+		if (onBitboards ? !(explorable & inside) : numExplorable == 0) {
 			
 			#ifdef DEBUG
 			cout << "case3: No more moves" << endl;
@@ -101,70 +151,59 @@ Agent::Action MyAI::getAction
 			if (canShoot && wumpusSensed) {
 				int r = wumpusFirstSeen.first;
 				int c = wumpusFirstSeen.second;
-				queue<pair<int, int>> route = generateRoute(r, c);
+				generateRoute(r, c, route);
 				int finalDir = 0;
-				qActions = routeToActions(route, finalDir, false);
+				routeToActions(route, finalDir, false);
 
 				// determine where to shoot
 				// TO-DO: MAKE FUNCTION
-				pair<int, int> wumpus(0, 0);
-				vector<pair<int, int>> nbs = getNeighbors(r, c);
-				for (pair<int, int> nb: nbs) {
-					if (grids[nb.first][nb.second] == 4) {
-						wumpus.first = nb.first;
-						wumpus.second = nb.second;
+				pair<int, int> target(0, 0);
+				pair<int, int> nbs[4];
+				int numNbs = getNeighbors(r, c, nbs);
+				for (int i = 0; i < numNbs; ++i) {
+					if (getStatus(nbs[i].first, nbs[i].second) == WUMPUS) {
+						target.first = nbs[i].first;
+						target.second = nbs[i].second;
 					}
 				}
 				// turn to face the wumpus
 				// TO-DO: MAKE FUNCTION
 				int tarDir = 0;
 				// determine the direction of next movement
-				if (wumpus.first == r - 1) // face South
+				if (target.first == r - 1) // face South
 					tarDir = 2;
-				else if (wumpus.first == r + 1) // face North
+				else if (target.first == r + 1) // face North
 					tarDir = 0;
-				else if (wumpus.second == c - 1) // face West
+				else if (target.second == c - 1) // face West
 					tarDir = 3;
 				else // face East
 					tarDir = 1;
 				// make turn as necessary
-				vector<Agent::Action> turns = makeTurns(finalDir, tarDir);
-				for (auto turn: turns)
-					qActions.push(turn);
+				makeTurns(finalDir, tarDir);
 				qActions.push(SHOOT);
-				Action nextAction = qActions.front();
-				qActions.pop();
+				Action nextAction = qActions.take();
 				prevAction = nextAction;
 				canShoot = false;
-				grids[wumpus.first][wumpus.second] = 2;
+				setStatus(target.first, target.second, EXPLORABLE);
 				return nextAction;
 			}
 
-			// generate a route to entrance
-			queue<pair<int, int>> route = generateRoute(0, 0);
-			// transform the route to a queue of actions, attach CLIMB
-			int ph = 0;
-			qActions = routeToActions(route, ph, true);
-			Action nextAction = qActions.front();
-			qActions.pop();
-			prevAction = nextAction;
-			return nextAction;
+			return chooseRiskOrEscape();
 		}
 		// case4: move to the closest explorable grid through a safe route
 		else {
-			pair<int, int> dest = getNearestGrid(explorable);
+			pair<int, int> dest;
+			getNearestGrid(dest, route);
 			
 			#ifdef DEBUG
 			cout << "case4: Move to: " << dest.first << "," << dest.second << endl;
 			#endif
 			
-			queue<pair<int, int>> route = generateRoute(dest.first, dest.second);
-			
 			#ifdef DEBUG
 			cout << "route sz: " << route.size() << endl;
 			#endif
 			int ph = 0;
-			qActions = routeToActions(route, ph, false);
+			routeToActions(route, ph, false);
 			Action nextAction = qActions.front();
 
 
@@ -179,6 +218,39 @@ Agent::Action MyAI::getAction
 	}
 }
 
+Agent::Action MyAI::chooseRiskOrEscape() {
+	// a grid the beliefs prove safe before giving up on the gold
+	pair<int, int> dest;
+	if (getProvenSafe(dest))
+		return takeRisk(dest.first, dest.second);
+	return escape();
+}
+
+Agent::Action MyAI::takeRisk(int r, int c) {
+
+	#ifdef DEBUG
+	cout << "case3: Risk: " << r << "," << c << endl;
+	#endif
+
+	generateRoute(r, c, route);
+	int ph = 0;
+	routeToActions(route, ph, false);
+	Action nextAction = qActions.take();
+	prevAction = nextAction;
+	return nextAction;
+}
+
+Agent::Action MyAI::escape() {
+	// generate a route to entrance
+	generateRoute(0, 0, route);
+	// transform the route to a queue of actions, attach CLIMB
+	int ph = 0;
+	routeToActions(route, ph, true);
+	Action nextAction = qActions.take();
+	prevAction = nextAction;
+	return nextAction;
+}
+
 void MyAI::updateAgentStatus(Agent::Action prev) {
 	// store previous position
 	prevR = curR;
@@ -201,84 +273,173 @@ void MyAI::updateAgentStatus(Agent::Action prev) {
 }
 
 
-vector<pair<int, int>> MyAI::getNeighbors(int r, int c) {
-	vector<pair<int, int>> retVal;
+int MyAI::getNeighbors(int r, int c, pair<int, int> nbs[4]) {
+	int n = 0;
 	if (r != 0)
-		retVal.push_back(make_pair(r-1, c));
+		nbs[n++] = make_pair(r-1, c);
 	if (r != sizeR-1)
-		retVal.push_back(make_pair(r+1, c));
+		nbs[n++] = make_pair(r+1, c);
 	if (c != 0)
-		retVal.push_back(make_pair(r, c-1));
+		nbs[n++] = make_pair(r, c-1);
 	if (c != sizeC-1)
-		retVal.push_back(make_pair(r, c+1));
-	return retVal;
+		nbs[n++] = make_pair(r, c+1);
+	return n;
 }
 
 void MyAI::updateBoard(bool st, bool br, bool gl, bool bp, bool sc) {
-	// set current grid to visited
-	grids[curR][curC] = 1;
-	
-	if (gl) {
-		goldFetched = true;
-		// generate a route to the entrance
-		queue<pair<int, int>> route = generateRoute(0, 0);
-		// transform the route to a queue of actions
-		int ph = 0;
-		qActions = routeToActions(route, ph, true);
-		return; // game win
-	}
 	if (bp) {
-		// restore current position to the previous position
+		// restore current position to the previous position,
+		// the agent never got into the grid beyond the wall
 		curR = prevR;
 		curC = prevC;
 		// update board status
 		// if agent is facing EAST, 
 		// update sizeC and set the grids beyond the wall unmovable
-		if (dir%4 == 1) { // 1 is EAST
-			sizeC = curC + 1;
-			for (int r = 0; r < MAXSIZE; ++r) {
-				for (int c = curC+1; c < MAXSIZE; ++c)
-					grids[r][c] = 3; // 3 is unmovable
-			}		
-		}
+		if (dir%4 == 1) // 1 is EAST
+			resizeBoard(sizeR, curC + 1);
 		// do the same if agent is facing NORTH
-		else if (dir%4 == 0) { // 0 is NORTH
-			sizeR = curR + 1;
-			for (int r = curR+1; r < MAXSIZE; ++r) {
-				for (int c = 0; c < MAXSIZE; ++c)
-					grids[r][c] = 3; // 3 is unmovable
-			}		
-		}
+		else if (dir%4 == 0) // 0 is NORTH
+			resizeBoard(curR + 1, sizeC);
 		// Do nothing if agent bumps into WEST or SOUTH wall (shouldn't happen)
 
 		// SHOULD NOT happen, just buy an insurance
 		// if BUMP happens during action queue, abondon the queue
 		if (!qActions.empty()) {
-			queue<Action>().swap(qActions);
+			qActions.clear();
 			return;
 		}
 	}
-	if (sc) {
-		// set all grids labeled "wumpus" to "explorable"
-		for (int r = 0; r < sizeR; ++r) {
-			for (int c = 0; c < sizeC; ++c) {
-				if (grids[r][c] == 4) // 4 is wumpus
-					grids[r][c] == 2; // 2 is explorable
+	// the neighbors of the current grid must be in the store,
+	// and on the bitboards, in the corner
+	if (onBitboards && max(curR, curC) + 1 >= BITSIZE)
+		leaveBitboards();
+	reserveBoard(curR + 1, curC + 1);
+	// set current grid to visited
+	if (getStatus(curR, curC) != VISITED) {
+		visitedGrids.push_back(make_pair(curR, curC));
+		if (onBitboards)
+			addRoutable(curR, curC);
+	}
+	setStatus(curR, curC, VISITED);
+	
+	if (gl) {
+		goldFetched = true;
+		// generate a route to the entrance
+		generateRoute(0, 0, route);
+		// transform the route to a queue of actions
+		int ph = 0;
+		routeToActions(route, ph, true);
+		return; // game win
+	}
+	Grid& here = at(curR, curC);
+	bool newBreeze = br && !(here.flags & BREEZE);
+	if (br)
+		here.flags |= BREEZE;
+	if (st)
+		here.flags |= STENCH;
+	pair<int, int> nbs[4];
+	int numNbs = getNeighbors(curR, curC, nbs);
+
+	updateWumpusCand(st, sc, nbs, numNbs);
+	// the agent is alive, so this grid holds no pit,
+	// and without breeze neither do its neighbors
+	markPitSafe(curR, curC);
+	if (!br)
+		for (int i = 0; i < numNbs; ++i)
+			markPitSafe(nbs[i].first, nbs[i].second);
+	if (newBreeze) {
+		breezyGrids.push_back(make_pair(curR, curC));
+		addPitClause(curR, curC);
+	}
+	updateNeighbors(st, br, nbs, numNbs);
+}
+
+void MyAI::updateWumpusCand(bool st, bool sc, pair<int, int> nbs[4], int numNbs) {
+	// on scream the statuses do not change: the grid shot at was set explorable when shooting
+	// the other wumpus candidates are kept, exploring them was measured to lose score
+	// the beliefs do change: the wumpus is dead, or nowhere along the arrow's path
+	// a dead wumpus keeps the candidates it could have died in
+	if (prevAction == SHOOT) {
+		int d = dir % 4;
+		if (onBitboards) {
+			// in front of the agent, on the arrow's line
+			Bitboard line = 0;
+			for (int r = curR, c = curC; isInside(r, c) && r < BITSIZE && c < BITSIZE; r += dr[d], c += dc[d])
+				line |= gridBit(r, c);
+			wumpusCandBits &= sc ? line : ~line;
+		}
+		else {
+			int n = 0;
+			for (int i = 0; i < numWumpusCand; ++i) {
+				int r = wumpusCand[i].first;
+				int c = wumpusCand[i].second;
+				// in front of the agent, on the arrow's line
+				bool hit = d % 2 == 0 ? c == curC && (r - curR) * dr[d] >= 0
+									   : r == curR && (c - curC) * dc[d] >= 0;
+				if (hit == sc)
+					wumpusCand[n++] = wumpusCand[i];
 			}
+			numWumpusCand = n;
 		}
+		wumpusDead = sc;
 	}
+	// the agent is alive, so this grid holds neither,
+	// and the percepts tell about its neighbors
+	if (onBitboards) {
+		// the wumpus is next to a stench, and not next to a grid without one,
+		// so before the first stench these are the grids it is not ruled out of
+		Bitboard here = gridBit(curR, curC);
+		if (!wumpusDead)
+			wumpusCandBits &= st ? expand(here) : ~(here | expand(here));
+		wumpusCandKnown = wumpusCandKnown || st;
+	}
+	else if (st && !wumpusCandKnown) {
+		// the first stench: the wumpus is one of the neighbors
+		// not ruled out by a visited grid without stench
+		wumpusCandKnown = true;
+		for (int i = 0; i < numNbs; ++i) {
+			int r = nbs[i].first;
+			int c = nbs[i].second;
+			bool ruledOut = (r == 0 && c == 0) || at(r, c).status == VISITED;
+			for (int d = 0; d < 4 && !ruledOut; ++d) {
+				int nr = r + dr[d];
+				int nc = c + dc[d];
+				if (nr >= 0 && nc >= 0 && nr < capR && nc < capC && at(nr, nc).status == VISITED
+					&& !(at(nr, nc).flags & STENCH))
+					ruledOut = true;
+			}
+			if (!ruledOut)
+				wumpusCand[numWumpusCand++] = nbs[i];
+		}
+	}
+	else if (!wumpusDead) {
+		// keep the candidates next to a stench, drop those next to no stench
+		int n = 0;
+		for (int i = 0; i < numWumpusCand; ++i) {
+			int dist = abs(wumpusCand[i].first - curR) + abs(wumpusCand[i].second - curC);
+			if (st ? dist == 1 : dist > 1)
+				wumpusCand[n++] = wumpusCand[i];
+		}
+		numWumpusCand = n;
+	}
+}
+
+void MyAI::updateNeighbors(bool st, bool br, pair<int, int> nbs[4], int numNbs) {
+	Bitboard neighbors = onBitboards ? expand(gridBit(curR, curC)) : 0;
 	// update status of neighbor grids according to breeze and stench
 	// breeze will overwrite stench
-	vector<pair<int, int>> neighbors = getNeighbors(curR, curC);
 	// if breeze, all unvisited neighbors are set to unmovable
 	// stench is ignored in the existence of breeze
 	if (br) {
-		for (pair<int, int> nb: neighbors) {
-			int r = nb.first;
-			int c = nb.second;
-			// handling logic with great care
-			if (grids[r][c] != 1 && grids[r][c] != 2) // 1 is visited, 2 is explorable
-				grids[r][c] = 3;
+		// handling logic with great care
+		if (onBitboards)
+			setStatus(neighbors & ~visited & ~explorable, UNMOVABLE);
+		else {
+			for (int i = 0; i < numNbs; ++i) {
+				Status s = at(nbs[i].first, nbs[i].second).status;
+				if (s != VISITED && s != EXPLORABLE)
+					setStatus(nbs[i].first, nbs[i].second, UNMOVABLE);
+			}
 		}
 	}
 	// if only stench is present
@@ -291,59 +452,184 @@ void MyAI::updateBoard(bool st, bool br, bool gl, bool bp, bool sc) {
 			wumpusFirstSeen.second = curC;
 		}
 		// if wumpus is not locked yet, try to lock wumpus first
+		// a candidate that is also next to this stench must be the wumpus
 		if (!wumpusLocked) {
-			for (pair<int, int> nb: neighbors) {
-				int r = nb.first;
-				int c = nb.second;
-				if (grids[r][c] == 4)
-					lockWumpus(r, c);
+			for (int i = 0; i < numNbs; ++i) {
+				if (getStatus(nbs[i].first, nbs[i].second) == WUMPUS) {
+					lockWumpus(nbs[i].first, nbs[i].second);
+					break;
+				}
 			}
 		}
 		// failed to lock wumpus, update wumpus's possible positions
 		if (!wumpusLocked) {
-			for (pair<int, int> nb: neighbors) {
-				int r = nb.first;
-				int c = nb.second;
-				// handling logic with great care
-				if (grids[r][c] != 1 && grids[r][c] != 2 && grids[r][c] != 3)
-					grids[r][c] = 4;
+			// handling logic with great care
+			if (onBitboards)
+				setStatus(neighbors & ~visited & ~explorable & ~unmovable, WUMPUS);
+			else {
+				for (int i = 0; i < numNbs; ++i) {
+					Status s = at(nbs[i].first, nbs[i].second).status;
+					if (s == UNKNOWN || s == WUMPUS)
+						setStatus(nbs[i].first, nbs[i].second, WUMPUS);
+				}
 			}
 		}
 		// sensing stench and wumpus is locked
 		else {	
-			for (pair<int, int> nb: neighbors) {
-				int r = nb.first;
-				int c = nb.second;
-				// handling logic with great care
-				if (grids[r][c] != 1 && grids[r][c] != 4)
-					grids[r][c] = 2;
+			// handling logic with great care
+			if (onBitboards)
+				setStatus(neighbors & ~visited & ~wumpus, EXPLORABLE);
+			else {
+				for (int i = 0; i < numNbs; ++i) {
+					Status s = at(nbs[i].first, nbs[i].second).status;
+					if (s != VISITED && s != WUMPUS)
+						setStatus(nbs[i].first, nbs[i].second, EXPLORABLE);
+				}
 			}
 		}
 	}
 	// neighbors are safe, set unvisited nbs to explorable
+	else if (onBitboards)
+		setStatus(neighbors & ~visited, EXPLORABLE);
 	else {
-		for (pair<int, int> nb: neighbors) {
-			int r = nb.first;
-			int c = nb.second;
-			if (grids[r][c] != 1)
-				grids[r][c] = 2; // 2 is explorable
+		for (int i = 0; i < numNbs; ++i)
+			if (at(nbs[i].first, nbs[i].second).status != VISITED)
+				setStatus(nbs[i].first, nbs[i].second, EXPLORABLE);
+	}
+}
+
+MyAI::Bitboard MyAI::expand(Bitboard grids) {
+	// a grid in the first column has no west neighbor, one in the last column no east neighbor
+	const Bitboard firstCol = 0x0101010101010101ULL;
+	const Bitboard lastCol = firstCol << (BITSIZE - 1);
+	Bitboard retVal = (grids << BITSIZE) // North
+					| (grids >> BITSIZE) // South
+					| ((grids & ~lastCol) << 1) // East
+					| ((grids & ~firstCol) >> 1); // West
+	return retVal & inside;
+}
+
+void MyAI::leaveBitboards() {
+	// only the used corner can differ from a new grid, see reset()
+	for (int r = 0; r < usedR; ++r) {
+		for (int c = 0; c < usedC; ++c) {
+			Grid& grid = at(r, c);
+			grid.status = getStatus(r, c);
+			if (grid.status == EXPLORABLE)
+				++numExplorable;
+			if (grid.status == WUMPUS)
+				wumpusGrids.push_back(make_pair(r, c));
+		}
+	}
+	if (wumpusCandKnown) {
+		for (Bitboard b = wumpusCandBits; b && numWumpusCand < 4; b &= b - 1) {
+			int index = __builtin_ctzll(b);
+			wumpusCand[numWumpusCand++] = make_pair(index / BITSIZE, index % BITSIZE);
+		}
+	}
+	onBitboards = false;
+}
+
+void MyAI::reserveBoard(int r, int c) {
+	usedR = max(usedR, r + 1);
+	usedC = max(usedC, c + 1);
+	if (r < capR && c < capC)
+		return;
+	// double until (r, c) fits, moving the used corner over
+	int newR = capR;
+	int newC = capC;
+	while (newR <= r)
+		newR *= 2;
+	while (newC <= c)
+		newC *= 2;
+	vector<Grid> larger(newR * newC, Grid());
+	for (int i = 0; i < min(usedR, capR); ++i)
+		for (int j = 0; j < min(usedC, capC); ++j)
+			larger[i * newC + j] = at(i, j);
+	board.swap(larger);
+	capR = newR;
+	capC = newC;
+	searchQueue.resize(capR * capC * 4);
+}
+
+void MyAI::resizeBoard(int rows, int cols) {
+	sizeR = rows;
+	sizeC = cols;
+	if (onBitboards) {
+		// the first sizeR rows of the corner, each cut down to its first sizeC columns
+		Bitboard row = (1ULL << min(sizeC, BITSIZE)) - 1;
+		inside = 0;
+		for (int r = 0; r < min(sizeR, BITSIZE); ++r)
+			inside |= row << (r * BITSIZE);
+	}
+	// only the used corner can hold grids beyond the wall, and within it
+	// only the row or column just beyond it, so this is one line of grids
+	for (int r = 0; r < usedR; ++r) {
+		for (int c = r < sizeR ? min(sizeC, usedC) : 0; c < usedC; ++c) {
+			setStatus(r, c, UNMOVABLE);
+			markPitSafe(r, c);
 		}
 	}
 }
 
+MyAI::Status MyAI::getStatus(int r, int c) {
+	if (!onBitboards)
+		return at(r, c).status;
+	if (r >= BITSIZE || c >= BITSIZE)
+		return UNKNOWN;
+	Bitboard grid = gridBit(r, c);
+	if (visited & grid)
+		return VISITED;
+	if (explorable & grid)
+		return EXPLORABLE;
+	if (unmovable & grid)
+		return UNMOVABLE;
+	if (wumpus & grid)
+		return WUMPUS;
+	return UNKNOWN;
+}
+
+void MyAI::setStatus(int r, int c, Status status) {
+	if (onBitboards) {
+		setStatus(gridBit(r, c), status);
+		return;
+	}
+	Grid& grid = at(r, c);
+	if (grid.status == EXPLORABLE)
+		--numExplorable;
+	if (status == EXPLORABLE)
+		++numExplorable;
+	if (status == WUMPUS && grid.status != WUMPUS)
+		wumpusGrids.push_back(make_pair(r, c));
+	grid.status = status;
+}
+
+void MyAI::setStatus(Bitboard grids, Status status) {
+	visited &= ~grids;
+	explorable &= ~grids;
+	unmovable &= ~grids;
+	wumpus &= ~grids;
+	if (status == VISITED)
+		visited |= grids;
+	else if (status == EXPLORABLE)
+		explorable |= grids;
+	else if (status == UNMOVABLE)
+		unmovable |= grids;
+	else if (status == WUMPUS)
+		wumpus |= grids;
+}
+
 
-queue<Agent::Action> MyAI::routeToActions(queue<pair<int, int>> route, 
-											int& finalDir, bool escape) {
+void MyAI::routeToActions(const Route& route, int& finalDir, bool escape) {
 	// record the status while moving along the route, 
 	// starting from current position, facing current direction
 	int r = curR;
 	int c = curC;
 	int d = dir;
-	queue<Agent::Action> retVal;
-	while (!route.empty()) {
-		pair<int, int> next = route.front(); // next grid in the route
+	qActions.clear();
+	for (int i = 0; i < route.size(); ++i) {
+		const pair<int, int>& next = route[i]; // next grid in the route
 		int tarDir = 0; // direction required to move to next grid
-		route.pop();
 
 		// determine the direction of next movement
 		if (next.first == r - 1) // move South
@@ -356,11 +642,9 @@ queue<Agent::Action> MyAI::routeToActions(queue<pair<int, int>> route,
 			tarDir = 1;
 		
 		// make turn as necessary
-		vector<Agent::Action> turns = makeTurns(d, tarDir);
-		for (auto turn: turns)
-			retVal.push(turn);
+		makeTurns(d, tarDir);
 		// move forward
-		retVal.push(FORWARD);
+		qActions.push(FORWARD);
 		// update status
 		r = next.first;
 		c = next.second;
@@ -368,186 +652,656 @@ queue<Agent::Action> MyAI::routeToActions(queue<pair<int, int>> route,
 	}
 	finalDir = d;
 	if (escape)
-		retVal.push(CLIMB);
-	return retVal;
+		qActions.push(CLIMB);
 }
 
-vector<Agent::Action> MyAI::makeTurns(int curDir, int tarDir) {
-	vector<Agent::Action> retVal;
+void MyAI::makeTurns(int curDir, int tarDir) {
 	// no need to change direction
 	if (curDir%4 == tarDir)
-		return retVal;
+		return;
 	// turn around: 1<->3, or 0<->2
 	else if ((curDir+tarDir)%2 == 0) {
-		retVal.push_back(TURN_LEFT);
-		retVal.push_back(TURN_LEFT);
+		qActions.push(TURN_LEFT);
+		qActions.push(TURN_LEFT);
 	}
 	// turn left: 0->3, 1->0, 2->1, or 3->2
 	else if ( (curDir%4 == 0 && tarDir == 3) || curDir%4 == tarDir+1 )
-		retVal.push_back(TURN_LEFT);
+		qActions.push(TURN_LEFT);
 	// turn right
 	else
-		retVal.push_back(TURN_RIGHT);
-	return retVal;
+		qActions.push(TURN_RIGHT);
 }
 
 // generate a safe route to the destination
-queue<pair<int, int>> MyAI::generateRoute(int destR, int destC) {
-	queue<pair<int, int>> retVal;
+void MyAI::generateRoute(int destR, int destC, Route& route) {
+	if (onBitboards) {
+		followCache(destR, destC, route);
+		return;
+	}
+	int endState = getEndState(destR, destC);
 
-	// must make the destination "reachable" by setting its status to 1(visited)
-	// this does not affect the board status 
-	// b/c the dest will be set to visited anyway on the agent's arrival
-	grids[destR][destC] = 1;
+	#ifdef DEBUG
+	cout << "~DEBUG~src: " << curR << ", " << curC << ", ";
+	cout << "dest: " << destR << ", " << destC << ", cost: " << getDistance(destR, destC) << endl;
+	#endif
 
-	pair<int, int> src(curR, curC);
-	pair<int, int> dest(destR, destC);
+	traceRoute(endState, destR, destC, route);
+}
+
+void MyAI::followCache(int destR, int destC, Route& route) {
+	route.clear();
+	int cost = 0;
+	int dest = getCachedEndState(destR, destC, cost);
+	if (dest == -1)
+		return;
 
-	// keep two board status, board is a local copy attached to each generateRoute()
-	// board: determine if a grid is already on the route(status 9)
-	// grids: determine if the route can pass through the grid(status 1)
-	vector<vector<int>> board = grids; // local copy's initial status doesn't matter
-	
-	vector<pair<int, int>> route;
-	vector<pair<int, int>> routeSoFar;
-	bool found = false;
-	
-	
 	#ifdef DEBUG
-	cout << "~DEBUG~src: " << src.first << ", " << src.second << ", ";
-	cout << "dest: " << dest.first << ", " << dest.second << endl;
-	cout << "grids visited: ";
-	for (int r = 0; r < sizeR; ++r)
-		for (int c = 0; c < sizeC; ++c)
-			if (grids[r][c] == 1)
-				cout << "(" << r << ", " << c << "), ";
-	cout << endl;
+	cout << "~DEBUG~src: " << curR << ", " << curC << ", ";
+	cout << "dest: " << destR << ", " << destC << ", cost: " << cost << endl;
 	#endif
-	
-	board[src.first][src.second] = 9; // put src onto route before BTS
-	generateRouteHelper(src, dest, board, route, routeSoFar, found);
-	for (int i = 0; i < route.size(); ++i)
-		retVal.push(route[i]);
-	return retVal;
-}
 
-void MyAI::generateRouteHelper(
-					pair<int, int> src,
-					pair<int, int> dest,
-					vector<vector<int>>& board,
-					vector<pair<int, int>>& routeToDest,
-					vector<pair<int, int>>& routeSoFar,
-					bool& found) {
+	// walk back one action at a time, to a state one action closer to the start,
+	// which keeps to the one row of the cache, the current state's
+	int src = (curR * BITSIZE + curC) * 4 + dir % 4;
+	trail.clear();
+	int state = dest;
+	while (state != src) {
+		int grid = state / 4;
+		int d = state % 4;
+		int r = grid / BITSIZE;
+		int c = grid % BITSIZE;
+		int cost = getCachedDistance(src, state);
+		// predecessors: FORWARD from behind, TURN_RIGHT, TURN_LEFT
+		int pr = r - dr[d];
+		int pc = c - dc[d];
+		if (pr >= 0 && pc >= 0 && pr < BITSIZE && pc < BITSIZE && (routable & gridBit(pr, pc))
+			&& getCachedDistance(src, (pr * BITSIZE + pc) * 4 + d) == cost - 1) {
+			trail.push_back(make_pair(r, c));
+			state = (pr * BITSIZE + pc) * 4 + d;
+		}
+		else if (getCachedDistance(src, grid * 4 + (d + 3) % 4) == cost - 1)
+			state = grid * 4 + (d + 3) % 4;
+		else
+			state = grid * 4 + (d + 1) % 4;
+	}
+	for (int i = trail.size() - 1; i >= 0; --i)
+		route.push(trail[i]);
+	// the last FORWARD into an unvisited destination
+	if (!(routable & gridBit(destR, destC)))
+		route.push(make_pair(destR, destC));
+}
 
-	/* #ifdef DEBUG
-	cout << "BT|src: (" << src.first << ", " << src.second
-		<< "), sz of routeSoFar: " << routeSoFar.size() << endl;
-	#endif */
-	
+void MyAI::addRoutable(int r, int c) {
+	routable |= gridBit(r, c);
+	cacheSlot[r * BITSIZE + c] = numRoutable;
+	slotGrid[numRoutable++] = r * BITSIZE + c;
+	memset(freshRows, 0, sizeof(freshRows));
 
+	// room for 4 more columns; every row is stale, so none need moving
+	int numStates = numRoutable * 4;
+	if (numStates > cacheStride)
+		cacheStride *= 2;
+	distCache.resize(numStates * cacheStride);
+}
 
-	// base case: when to stop
-	if (src.first == dest.first && src.second == dest.second) {
-		found = true;
-		routeToDest = routeSoFar;
+void MyAI::fillRow(int a) {
+	const int INF = 255;
+	const Bitboard firstCol = 0x0101010101010101ULL;
+	const Bitboard lastCol = firstCol << (BITSIZE - 1);
+	unsigned char* row = &distCache[a * cacheStride];
+	memset(row, INF, numRoutable * 4);
+	// the search goes a layer of equal distance at a time,
+	// with the grids reached facing each direction on a bitboard
+	Bitboard layer[4] = {0, 0, 0, 0};
+	Bitboard seen[4];
+	layer[a % 4] = 1ULL << slotGrid[a / 4];
+	for (int d = 0; d < 4; ++d)
+		seen[d] = layer[d];
+	for (int dist = 0; layer[0] | layer[1] | layer[2] | layer[3]; ++dist) {
+		for (int d = 0; d < 4; ++d)
+			for (Bitboard b = layer[d]; b; b &= b - 1)
+				row[cacheSlot[__builtin_ctzll(b)] * 4 + d] = dist;
+		// a FORWARD keeps the facing, a turn keeps the grid
+		Bitboard ahead[4] = {layer[0] << BITSIZE, (layer[1] & ~lastCol) << 1,
+							 layer[2] >> BITSIZE, (layer[3] & ~firstCol) >> 1};
+		Bitboard next[4];
+		for (int d = 0; d < 4; ++d)
+			next[d] = ((ahead[d] & routable) | layer[(d + 1) % 4] | layer[(d + 3) % 4]) & ~seen[d];
+		for (int d = 0; d < 4; ++d) {
+			layer[d] = next[d];
+			seen[d] |= next[d];
+		}
 	}
-	// makes BTS ends early (while not finding every possible solution)
-	if (found)
-		return;
-	// retrive the frontier of src, sort by distance to dest
-	vector<pair<pair<int, int>, int>> frontier = getFrontier(src, dest);
-	if (frontier.empty())
-		return;
-	sort(frontier.begin(), frontier.end(), compare);
-	// run BTS on the frontier
-	for (pair<pair<int, int>, int> fr: frontier) {
-		// a status is stored in board to avoid passing through a grid multiple times
-		// board[r][c] == 9 -- already on the route
-		// all other values -- not on the route yet
-		int r = fr.first.first; // row
-		int c = fr.first.second; // column
-		if (board[r][c] != 9) {
-			board[r][c] = 9;
-			routeSoFar.push_back(fr.first);
-			generateRouteHelper(fr.first, dest, board, routeToDest, routeSoFar, found);
-			routeSoFar.pop_back();
-			board[r][c] = 1; // any value not 9 suffices
-		}
-	}
-}
-
-vector<pair<pair<int, int>, int>> MyAI::getFrontier(
-				pair<int, int> src,
-				pair<int, int> dest) {
-	vector<pair<pair<int, int>, int>> retVal;
-	vector<pair<int, int>> neighbors;
-	neighbors = getNeighbors(src.first, src.second);
-	// frontier is defined as all nbs that are visited and not on the route
-	for (pair<int, int> nb : neighbors) {
-		if (grids[nb.first][nb.second] == 1) {
-			int distance = (nb.first - dest.first) * (nb.first - dest.first)
-						+ (nb.second - dest.second) * (nb.second - dest.second);
-			retVal.push_back(make_pair(nb, distance));
+	freshRows[a / 64] |= 1ULL << (a % 64);
+}
+
+int MyAI::getCachedEndState(int destR, int destC, int& cost) {
+	int src = (curR * BITSIZE + curC) * 4 + dir % 4;
+	int retVal = -1;
+	cost = INT_MAX;
+	for (int d = 0; d < 4; ++d) {
+		// end at the destination itself, facing d
+		if (routable & gridBit(destR, destC)) {
+			int state = (destR * BITSIZE + destC) * 4 + d;
+			if (getCachedDistance(src, state) < cost) {
+				cost = getCachedDistance(src, state);
+				retVal = state;
+			}
+			continue;
+		}
+		// end next to it, facing it
+		int r = destR - dr[d];
+		int c = destC - dc[d];
+		if (r >= 0 && r < BITSIZE && c >= 0 && c < BITSIZE && (routable & gridBit(r, c))) {
+			int state = (r * BITSIZE + c) * 4 + d;
+			if (getCachedDistance(src, state) + 1 < cost) {
+				cost = getCachedDistance(src, state) + 1;
+				retVal = state;
+			}
 		}
 	}
 	return retVal;
 }
 
-bool MyAI::compare(pair<pair<int, int>, int> a, pair<pair<int, int>, int> b) {
-	return a.second <= b.second;
+int MyAI::getCachedDistance(int from, int to) {
+	int a = cacheSlot[from / 4] * 4 + from % 4;
+	if (!(freshRows[a / 64] >> (a % 64) & 1))
+		fillRow(a);
+	return distCache[a * cacheStride + cacheSlot[to / 4] * 4 + to % 4];
 }
 
-vector<pair<int, int>> MyAI::getExplorable() {
-	vector<pair<int, int>> retVal;
-	for (int r = 0; r < sizeR; ++r) {
-		for (int c = 0; c < sizeC; ++c) {
-			if (grids[r][c] == 2)
-				retVal.push_back(make_pair(r, c));
+template <typename Goal>
+void MyAI::search(Goal goal) {
+	++searchStamp;
+	int src = (curR * capC + curC) * 4 + dir % 4;
+	Grid& start = at(curR, curC);
+	start.searchMark = searchStamp;
+	for (int d = 0; d < 4; ++d)
+		start.dist[d] = INT_MAX;
+	start.dist[dir % 4] = 0;
+	searchQueue[0] = src;
+	int head = 0;
+	int tail = 1;
+	int layer = 0;
+	bool found = false;
+	while (head < tail) {
+		int state = searchQueue[head++];
+		int grid = state / 4;
+		int d = state % 4;
+		int r = grid / capC;
+		int c = grid % capC;
+		int cost = board[grid].dist[d];
+		if (cost != layer) {
+			if (found)
+				return;
+			layer = cost;
+		}
+		if (goal(state))
+			found = true;
+		// successors: FORWARD, TURN_LEFT, TURN_RIGHT
+		int next[3] = {-1, grid * 4 + (d + 3) % 4, grid * 4 + (d + 1) % 4};
+		int nr = r + dr[d];
+		int nc = c + dc[d];
+		if (nr >= 0 && nc >= 0 && nr < capR && nc < capC && at(nr, nc).status == VISITED)
+			next[0] = (nr * capC + nc) * 4 + d;
+		for (int i = 0; i < 3; ++i) {
+			if (next[i] == -1)
+				continue;
+			Grid& to = board[next[i] / 4];
+			if (to.searchMark != searchStamp) {
+				to.searchMark = searchStamp;
+				for (int k = 0; k < 4; ++k)
+					to.dist[k] = INT_MAX;
+			}
+			if (to.dist[next[i] % 4] == INT_MAX) {
+				to.dist[next[i] % 4] = cost + 1;
+				searchQueue[tail++] = next[i];
+			}
 		}
 	}
-	#ifdef DEBUG
-	cout << "Explorable: ";
-	for (auto it = retVal.begin(); it != retVal.end(); ++it)
-		cout << "(" << (*it).first << ", " << (*it).second << "), ";
-	cout << endl;
-	#endif
-	
+}
+
+int MyAI::getStateDistance(int state) {
+	const Grid& grid = board[state / 4];
+	return grid.searchMark == searchStamp ? grid.dist[state % 4] : INT_MAX;
+}
+
+int MyAI::getEndState(int destR, int destC) {
+	int retVal = -1;
+	bool routable = at(destR, destC).status == VISITED;
+	search([&](int state) {
+		int grid = state / 4;
+		int d = state % 4;
+		// end at the destination itself, or next to it, facing it
+		bool ends = routable ? grid == destR * capC + destC
+							 : grid / capC + dr[d] == destR && grid % capC + dc[d] == destC;
+		if (!ends)
+			return false;
+		if (retVal == -1 || d < retVal % 4)
+			retVal = state;
+		return true;
+	});
 	return retVal;
 }
 
-pair<int, int> MyAI::getNearestGrid(vector<pair<int, int>> cand) {
-	int minDist = MAXSIZE * MAXSIZE;
-	pair<int, int> retVal;
-	for (pair<int, int> grid: cand) {
-		int dist = getDistance(grid.first, grid.second);
-		if (dist < minDist) {
-			minDist = dist;
-			retVal = make_pair(grid.first, grid.second);
+void MyAI::traceRoute(int endState, int destR, int destC, Route& route) {
+	route.clear();
+	if (endState == -1)
+		return;
+
+	// walk back one action at a time, to a state one action closer to the start
+	trail.clear();
+	int state = endState;
+	while (getStateDistance(state) > 0) {
+		int grid = state / 4;
+		int d = state % 4;
+		int r = grid / capC;
+		int c = grid % capC;
+		int cost = getStateDistance(state);
+		// predecessors: FORWARD from behind, TURN_RIGHT, TURN_LEFT
+		int pr = r - dr[d];
+		int pc = c - dc[d];
+		if (pr >= 0 && pc >= 0 && pr < capR && pc < capC
+			&& getStateDistance((pr * capC + pc) * 4 + d) == cost - 1) {
+			trail.push_back(make_pair(r, c));
+			state = (pr * capC + pc) * 4 + d;
 		}
+		else if (getStateDistance(grid * 4 + (d + 3) % 4) == cost - 1)
+			state = grid * 4 + (d + 3) % 4;
+		else
+			state = grid * 4 + (d + 1) % 4;
 	}
-	return retVal;
+	for (int i = trail.size() - 1; i >= 0; --i)
+		route.push(trail[i]);
+	// the last FORWARD into an unvisited destination
+	if (at(destR, destC).status != VISITED)
+		route.push(make_pair(destR, destC));
+}
+
+void MyAI::getNearestGrid(pair<int, int>& dest, Route& route) {
+	if (onBitboards) {
+		int minDist = INT_MAX;
+		Bitboard cand = explorable & inside;
+		int first = __builtin_ctzll(cand);
+		dest = make_pair(first / BITSIZE, first % BITSIZE);
+		// lowest bit first, which is row by row
+		for (Bitboard b = cand; b; b &= b - 1) {
+			int index = __builtin_ctzll(b);
+			int dist = getDistance(index / BITSIZE, index % BITSIZE);
+			if (dist < minDist) {
+				minDist = dist;
+				dest = make_pair(index / BITSIZE, index % BITSIZE);
+			}
+		}
+		followCache(dest.first, dest.second, route);
+		return;
+	}
+	int retVal = -1;
+	search([&](int state) {
+		int grid = state / 4;
+		int d = state % 4;
+		int r = grid / capC + dr[d];
+		int c = grid % capC + dc[d];
+		if (!isInside(r, c) || at(r, c).status != EXPLORABLE)
+			return false;
+		// every candidate of a layer is equally near
+		if (retVal == -1 || make_pair(r, c) < dest || (make_pair(r, c) == dest && d < retVal % 4)) {
+			retVal = state;
+			dest = make_pair(r, c);
+		}
+		return true;
+	});
+
+	#ifdef DEBUG
+	cout << "Explorable: " << numExplorable << ", nearest: (" << dest.first << ", " << dest.second << ")" << endl;
+	#endif
+
+	traceRoute(retVal, dest.first, dest.second, route);
 }
 
 int MyAI::getDistance(int r, int c) {
-	return (r - curR) * (r - curR) + (c - curC) * (c - curC);
+	int cost = INT_MAX;
+	if (onBitboards) {
+		getCachedEndState(r, c, cost);
+		return cost;
+	}
+	for (int d = 0; d < 4; ++d) {
+		// at the grid itself, or next to it, facing it
+		if (at(r, c).status == VISITED) {
+			cost = min(cost, getStateDistance((r * capC + c) * 4 + d));
+			continue;
+		}
+		int pr = r - dr[d];
+		int pc = c - dc[d];
+		if (pr >= 0 && pc >= 0 && pr < capR && pc < capC && at(pr, pc).status == VISITED) {
+			int toNeighbor = getStateDistance((pr * capC + pc) * 4 + d);
+			if (toNeighbor != INT_MAX)
+				cost = min(cost, toNeighbor + 1);
+		}
+	}
+	return cost;
 }
 
 void MyAI::lockWumpus(int r, int c) {
 	wumpusLocked = true;	
-	for (int i = 0; i < sizeR; ++i) {
-		for (int j = 0; j < sizeC; ++j) {
-			if (grids[i][j] == 4)
-				grids[i][j] = 2;
+	if (onBitboards)
+		setStatus(wumpus, EXPLORABLE);
+	for (size_t i = 0; i < wumpusGrids.size(); ++i)
+		if (at(wumpusGrids[i].first, wumpusGrids[i].second).status == WUMPUS)
+			setStatus(wumpusGrids[i].first, wumpusGrids[i].second, EXPLORABLE);
+	wumpusGrids.clear();
+	setStatus(r, c, WUMPUS);
+}
+
+void MyAI::addPitClause(int r, int c) {
+	pair<int, int> nbs[4];
+	int numNbs = getNeighbors(r, c, nbs);
+	int count = 0;
+	pair<int, int> last;
+	for (int i = 0; i < numNbs; ++i) {
+		unsigned char flags = at(nbs[i].first, nbs[i].second).flags;
+		// already satisfied
+		if (flags & PITCERTAIN)
+			return;
+		if (!(flags & PITSAFE)) {
+			++count;
+			last = nbs[i];
+		}
+	}
+	// cannot be satisfied, the percepts contradict each other
+	if (count == 0)
+		return;
+	at(r, c).flags |= ACTIVE;
+	touchPitClause(r, c);
+	if (count == 1)
+		markPit(last.first, last.second);
+}
+
+void MyAI::markPitSafe(int r, int c) {
+	Grid& grid = at(r, c);
+	if (grid.flags & PITSAFE)
+		return;
+	grid.flags |= PITSAFE;
+	// only the constraints of breezy neighbors are touched
+	// a grid beyond the wall can still be next to one
+	for (int d = 0; d < 4; ++d) {
+		int nr = r + dr[d];
+		int nc = c + dc[d];
+		if (nr >= 0 && nc >= 0 && nr < capR && nc < capC && (at(nr, nc).flags & ACTIVE))
+			updatePitClause(nr, nc);
+	}
+}
+
+void MyAI::updatePitClause(int r, int c) {
+	touchPitClause(r, c);
+	pair<int, int> nbs[4];
+	int numNbs = getNeighbors(r, c, nbs);
+	int count = 0;
+	pair<int, int> last;
+	for (int i = 0; i < numNbs; ++i) {
+		if (!(at(nbs[i].first, nbs[i].second).flags & PITSAFE)) {
+			++count;
+			last = nbs[i];
+		}
+	}
+	if (count == 1)
+		markPit(last.first, last.second);
+	// cannot be satisfied, the percepts contradict each other
+	else if (count == 0)
+		at(r, c).flags &= ~ACTIVE;
+}
+
+void MyAI::markPit(int r, int c) {
+	at(r, c).flags |= PITCERTAIN;
+	for (int d = 0; d < 4; ++d) {
+		int nr = r + dr[d];
+		int nc = c + dc[d];
+		if (nr >= 0 && nc >= 0 && nr < capR && nc < capC && (at(nr, nc).flags & ACTIVE)) {
+			at(nr, nc).flags &= ~ACTIVE;
+			touchPitClause(nr, nc);
+		}
+	}
+}
+
+void MyAI::touchPitClause(int r, int c) {
+	pair<int, int> nbs[4];
+	int numNbs = getNeighbors(r, c, nbs);
+	for (int i = 0; i < numNbs; ++i)
+		if (!(at(nbs[i].first, nbs[i].second).flags & PITSAFE))
+			at(nbs[i].first, nbs[i].second).flags |= DIRTY;
+}
+
+void MyAI::inferPits() {
+	// grow each component from one constraint, through the grids it shares
+	// with others; breezy grids are visited, so a mark never means both
+	++markStamp;
+	for (size_t k = 0; k < breezyGrids.size(); ++k) {
+		Grid& seed = at(breezyGrids[k].first, breezyGrids[k].second);
+		if (!(seed.flags & ACTIVE) || seed.mark == markStamp)
+			continue;
+		seed.mark = markStamp;
+		compGrids.clear();
+		compClauses.clear();
+		compStack.clear();
+		compStack.push_back(breezyGrids[k]);
+		bool dirty = false;
+		while (!compStack.empty()) {
+			pair<int, int> clause = compStack.back();
+			compStack.pop_back();
+			compClauses.push_back(clause);
+			pair<int, int> nbs[4];
+			int numNbs = getNeighbors(clause.first, clause.second, nbs);
+			for (int i = 0; i < numNbs; ++i) {
+				Grid& grid = at(nbs[i].first, nbs[i].second);
+				if ((grid.flags & PITSAFE) || grid.mark == markStamp)
+					continue;
+				grid.mark = markStamp;
+				compGrids.push_back(nbs[i]);
+				dirty = dirty || (grid.flags & DIRTY);
+				// the other constraints of this grid
+				for (int d = 0; d < 4; ++d) {
+					int nr = nbs[i].first + dr[d];
+					int nc = nbs[i].second + dc[d];
+					if (nr >= 0 && nc >= 0 && nr < capR && nc < capC
+						&& (at(nr, nc).flags & ACTIVE) && at(nr, nc).mark != markStamp) {
+						at(nr, nc).mark = markStamp;
+						compStack.push_back(make_pair(nr, nc));
+					}
+				}
+			}
+		}
+		if (dirty)
+			enumeratePits();
+	}
+}
+
+void MyAI::enumeratePits() {
+	int numCells = compGrids.size();
+	int numClauses = compClauses.size();
+	if (numCells > MAXENUMERATE) {
+		// too many models to count: the prior is a lower bound, since every
+		// constraint only makes pits more likely, so none of the grids is
+		// proven safe either way
+		for (int i = 0; i < numCells; ++i) {
+			Grid& grid = at(compGrids[i].first, compGrids[i].second);
+			grid.pitProb = PITPRIOR;
+			grid.flags &= ~DIRTY;
+		}
+		return;
+	}
+
+	// one clause per breeze, bit i is compGrids[i]:
+	// at least one of its frontier neighbors holds a pit
+	uint32_t clauses[MAXENUMERATE * 4];
+	for (int j = 0; j < numClauses; ++j) {
+		clauses[j] = 0;
+		for (int i = 0; i < numCells; ++i)
+			if (abs(compGrids[i].first - compClauses[j].first) + abs(compGrids[i].second - compClauses[j].second) == 1)
+				clauses[j] |= 1u << i;
+	}
+
+	// closing[first[i]] .. closing[first[i+1]-1]: the clauses whose last
+	// grid is compGrids[i], they must be satisfied once it is decided
+	int closing[MAXENUMERATE * 4];
+	int first[MAXENUMERATE + 1];
+	for (int i = 0; i <= numCells; ++i)
+		first[i] = 0;
+	for (int j = 0; j < numClauses; ++j)
+		++first[31 - __builtin_clz(clauses[j]) + 1];
+	for (int i = 0; i < numCells; ++i)
+		first[i+1] += first[i];
+	int filled[MAXENUMERATE];
+	for (int i = 0; i < numCells; ++i)
+		filled[i] = first[i];
+	for (int j = 0; j < numClauses; ++j)
+		closing[filled[31 - __builtin_clz(clauses[j])]++] = j;
+
+	// depth first over the grids in order, pit or no pit,
+	// weighing every model that satisfies all clauses by its prior
+	double total = 0;
+	double pitWeight[MAXENUMERATE] = {0};
+	uint32_t pits[MAXENUMERATE + 1];
+	double weight[MAXENUMERATE + 1];
+	int choice[MAXENUMERATE];
+	int depth = 0;
+	pits[0] = 0;
+	weight[0] = 1;
+	choice[0] = -1;
+	while (depth >= 0) {
+		if (depth == numCells) {
+			total += weight[depth];
+			for (uint32_t b = pits[depth]; b; b &= b - 1)
+				pitWeight[__builtin_ctz(b)] += weight[depth];
+			--depth;
+			continue;
+		}
+		// 0: no pit, 1: pit, 2: both tried
+		if (++choice[depth] == 2) {
+			--depth;
+			continue;
 		}
+		uint32_t next = pits[depth] | ((uint32_t)choice[depth] << depth);
+		bool satisfied = true;
+		for (int k = first[depth]; k < first[depth+1]; ++k)
+			if (!(clauses[closing[k]] & next)) {
+				satisfied = false;
+				break;
+			}
+		if (!satisfied)
+			continue;
+		pits[depth+1] = next;
+		weight[depth+1] = weight[depth] * (choice[depth] ? PITPRIOR : 1 - PITPRIOR);
+		++depth;
+		if (depth < numCells)
+			choice[depth] = -1;
+	}
+
+	for (int i = 0; i < numCells; ++i) {
+		Grid& grid = at(compGrids[i].first, compGrids[i].second);
+		grid.pitProb = total > 0 ? pitWeight[i] / total : 0;
+		grid.flags &= ~DIRTY;
+	}
+}
+
+double MyAI::getPitProb(int r, int c) {
+	const Grid& grid = at(r, c);
+	if (grid.flags & PITCERTAIN)
+		return 1;
+	if (grid.flags & PITSAFE)
+		return 0;
+	// part of a component if it is in an active constraint
+	for (int d = 0; d < 4; ++d) {
+		int nr = r + dr[d];
+		int nc = c + dc[d];
+		if (nr >= 0 && nc >= 0 && nr < capR && nc < capC && (at(nr, nc).flags & ACTIVE))
+			return grid.pitProb;
+	}
+	return PITPRIOR;
+}
+
+bool MyAI::inWumpusCand(int r, int c) {
+	if (onBitboards)
+		return r < BITSIZE && c < BITSIZE && (wumpusCandBits & gridBit(r, c));
+	return find(wumpusCand, wumpusCand + numWumpusCand, make_pair(r, c)) != wumpusCand + numWumpusCand;
+}
+
+double MyAI::getWumpusProb(int r, int c) {
+	// before the first stench, every grid next to a visited one is ruled out,
+	// and only those are asked about
+	if (!wumpusCandKnown || wumpusDead)
+		return 0;
+	if (onBitboards) {
+		Bitboard cand = wumpusCandBits & inside;
+		return (cand & gridBit(r, c)) ? 1.0 / __builtin_popcountll(cand) : 0;
 	}
-	grids[r][c] = 4;
+	int count = 0;
+	bool isCand = false;
+	for (int i = 0; i < numWumpusCand; ++i) {
+		if (!isInside(wumpusCand[i].first, wumpusCand[i].second))
+			continue;
+		++count;
+		if (wumpusCand[i] == make_pair(r, c))
+			isCand = true;
+	}
+	return isCand ? 1.0 / count : 0;
 }
 
-void MyAI::printActionQueue(queue<Agent::Action> q) {
-	while (!q.empty()) {
-		cout << q.front() << ", ";
-		q.pop();
+bool MyAI::getProvenSafe(pair<int, int>& dest) {
+	inferPits();
+	// the frontier, row by row
+	frontier.clear();
+	if (onBitboards) {
+		// the distances are in the cache
+		for (Bitboard b = expand(visited) & ~visited; b; b &= b - 1) {
+			int index = __builtin_ctzll(b);
+			frontier.push_back(make_pair(index / BITSIZE, index % BITSIZE));
+		}
 	}
+	else {
+		// every distance, the search never stops early
+		search([](int) { return false; });
+		++markStamp;
+		for (size_t k = 0; k < visitedGrids.size(); ++k) {
+			pair<int, int> nbs[4];
+			int numNbs = getNeighbors(visitedGrids[k].first, visitedGrids[k].second, nbs);
+			for (int i = 0; i < numNbs; ++i) {
+				Grid& grid = at(nbs[i].first, nbs[i].second);
+				if (grid.status == VISITED || grid.mark == markStamp)
+					continue;
+				grid.mark = markStamp;
+				frontier.push_back(nbs[i]);
+			}
+		}
+		sort(frontier.begin(), frontier.end());
+	}
+
+	// pits and the wumpus are placed independently
+	double minRisk = 2;
+	int minDist = INT_MAX;
+	for (size_t k = 0; k < frontier.size(); ++k) {
+		int r = frontier[k].first;
+		int c = frontier[k].second;
+		double risk = 1 - (1 - getPitProb(r, c)) * (1 - getWumpusProb(r, c));
+		int dist = getDistance(r, c);
+		if (dist == INT_MAX)
+			continue;
+		if (risk < minRisk || (risk == minRisk && dist < minDist)) {
+			minRisk = risk;
+			minDist = dist;
+			dest = make_pair(r, c);
+		}
+	}
+
+	#ifdef DEBUG
+	cout << "Least risk: " << minRisk << endl;
+	#endif
+
+	return minRisk == 0;
+}
+
+void MyAI::printActionQueue(const ActionPlan& q) {
+	for (int i = 0; i < q.size(); ++i)
+		cout << q[i] << ", ";
 	cout << endl;
 }
 // ======================================================================
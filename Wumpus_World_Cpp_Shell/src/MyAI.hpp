@@ -26,9 +26,12 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <cstring>
 #include "Agent.hpp"
-
-#define MAXSIZE 8
+#include "RingBuffer.hpp"
 
 using namespace std;
 
@@ -51,23 +54,100 @@ public:
 		bool bump,
 		bool scream
 	);
+
+	// restore the initial status for a new game
+	void reset(uint64_t seed);
 	// ======================================================================
 	// YOUR CODE BEGINS
 	// ======================================================================
-private:
-	// represents the dungeon in the form of grids[r][c], starting from grids[0][0]
-	// each grid has an int value representing its status
-	// 0  unknown, the initial status
-	// 1  visited, also implies a safe grid
-	// 2  explorable, but not visited yet
-	// 3  unmovable, could be a neighbor to "b", or a wall, will overwrite "wumpus"
-	// 4  wumpus, where the worm could be, will be overwritten by #3 
+	// protected, so search agents can build on what MyAI knows
+protected:
+	// a set of grids of the BITSIZE x BITSIZE corner of the dungeon,
+	// grid (r, c) is bit r*BITSIZE+c
+	typedef uint64_t Bitboard;
+	static const int BITSIZE = 8;
+	static_assert(BITSIZE * BITSIZE <= 64, "the corner must fit in a 64-bit bitboard");
+
+	// a route never enters a grid twice, an action plan holds
+	// at most two turns and a FORWARD per grid of a route,
+	// then two turns and a SHOOT, or a CLIMB
+	// both hold a route or plan of the corner inline, and only
+	// allocate on larger boards, growing to the longest one seen
+	typedef RingBuffer<pair<int, int>, BITSIZE*BITSIZE> Route;
+	static const int MAXACTIONS = BITSIZE*BITSIZE*3 + 3;
+	typedef RingBuffer<Action, MAXACTIONS> ActionPlan;
+
+	// each grid is in exactly one status, unknown is the initial one
+	// visited     also implies a safe grid
+	// explorable  not visited yet
+	// unmovable   could be a neighbor to "b", or a wall, will overwrite "wumpus"
+	// wumpus      where the worm could be, will be overwritten by unmovable
 	// *  wumpus is an inferior obstacle comparing to a pit or a wall
 	// the logic is carefully constructed to avoid the following situation:
 	// a pit overlaps the wumpus, which is removed later, 
 	// so the agent considers the grid safe, which is not.
-	vector<vector<int>> grids;
-	// the actual size of the dungeon
+	enum Status : unsigned char { UNKNOWN, VISITED, EXPLORABLE, UNMOVABLE, WUMPUS };
+
+	// what is known about a grid besides its status, see the beliefs below
+	enum GridFlag : unsigned char {
+		BREEZE = 1,      // visited, breeze sensed
+		STENCH = 2,      // visited, stench sensed
+		PITSAFE = 4,     // proven free of pits
+		PITCERTAIN = 8,  // proven pit: the last grid left in a constraint
+		ACTIVE = 16,     // breezy, its constraint is not satisfied yet
+		DIRTY = 32       // pitProb is out of date
+	};
+
+	struct Grid {
+		// only up to date once the statuses left the bitboards, see below
+		Status status;
+		unsigned char flags;
+		// marks of the last component search and route search that reached it
+		unsigned mark;
+		unsigned searchMark;
+		// actions from the start of the route search to this grid facing each
+		// direction, valid while searchMark is the current search
+		int dist[4];
+		// pit probability from the last enumeration of its component
+		double pitProb;
+	};
+
+	// the dungeon as known so far, row by row, starting from grid (0,0)
+	// the size of the dungeon is unknown until the agent bumps into its walls,
+	// so the store covers capR x capC grids and doubles when the agent gets
+	// near its edge; reset() keeps the memory, clearing the used corner only
+	// every grid outside usedR x usedC is unknown, with all fields zero
+	static const int INITIALSIZE = BITSIZE;
+	vector<Grid> board;
+	int capR;
+	int capC;
+	int usedR;
+	int usedC;
+
+	// while every grid the agent knows of is in the BITSIZE x BITSIZE
+	// corner, which covers every board of the tournament, the statuses
+	// are kept in one bitboard each, the wumpus candidates in another,
+	// and routes follow a distance cache; the first percept from the edge
+	// of the corner moves them to the store for the rest of the game,
+	// routes are searched from then on, see leaveBitboards()
+	// the percept flags and the pit constraints are in the store either way
+	bool onBitboards;
+	// a grid in none of them is unknown
+	Bitboard visited;
+	Bitboard explorable;
+	Bitboard unmovable;
+	Bitboard wumpus;
+	// the grids of the corner inside the actual size of the dungeon
+	Bitboard inside;
+
+	// off the bitboards: the number of explorable grids
+	int numExplorable;
+	// the visited grids, and off the bitboards,
+	// the grids set to "wumpus" since it was last locked
+	vector<pair<int, int>> visitedGrids;
+	vector<pair<int, int>> wumpusGrids;
+
+	// the actual size of the dungeon, INT_MAX until a wall is found
 	int sizeR; // number of rows
 	int sizeC; // number of columes
 	// agent's current zero-based position	
@@ -88,7 +168,9 @@ private:
 
 	// the queue of a series of predetermined actions
 	// if the queue is not empty, pop from the queue and return it as next action
-	queue<Action> qActions;
+	ActionPlan qActions;
+	// the route being planned, kept to reuse its memory
+	Route route;
 
 	// agent's previous action
 	// used to update status at the beginning of getAction()
@@ -109,6 +191,91 @@ private:
 	// the location when agent first sensors stench
 	// when shoot activated: agent moves to this location and shoot
 	pair<int, int> wumpusFirstSeen;
+
+	/*******************************
+ 	 * Subsection: distance cache
+	 *******************************/
+
+	// on the bitboards, a state is a grid and a facing direction:
+	// (r*BITSIZE+c)*4 + dir%4
+	static const int NUMSTATES = BITSIZE * BITSIZE * 4;
+
+	// all-pairs distance cache between states of routable grids,
+	// filled a row at a time when it is first read
+	// the cache numbers the routable grids in the order they were added,
+	// so the k-th grid's states are rows and columns k*4 .. k*4+3
+	// distCache[a*cacheStride+b] is the fewest actions (FORWARD, TURN_LEFT,
+	// TURN_RIGHT) to get from cached state a to cached state b through
+	// routable grids only; only entries between routable grids are valid
+	// the rows have room for cacheStride states, doubled when full, so
+	// copying an agent, as searches do, copies about what it has explored
+	vector<unsigned char> distCache;
+	int cacheStride;
+	// bit a%64 of freshRows[a/64] is set when row a is filled and current
+	Bitboard freshRows[NUMSTATES / 64];
+	// the grids in the cache, which are the visited grids
+	Bitboard routable;
+	// the cache number of each routable grid, and the grid of each number
+	int cacheSlot[BITSIZE * BITSIZE];
+	int slotGrid[BITSIZE * BITSIZE];
+	int numRoutable;
+
+	/*******************************
+ 	 * Subsection: route search
+	 *******************************/
+
+	// off the bitboards, a state is a grid and a facing direction:
+	// (r*capC+c)*4 + dir%4; routes are searched breadth first over the states of visited grids,
+	// stopping at the first layer that reaches the destination, so a search
+	// only touches the grids closer than it
+	// searchStamp  the current search, see Grid::searchMark
+	// searchQueue  the states in the order they are reached, 4 per grid
+	// trail        the grids of a route, from its end back to the agent
+	unsigned searchStamp;
+	vector<int> searchQueue;
+	vector<pair<int, int>> trail;
+
+	/*******************************
+ 	 * Subsection: beliefs
+	 *******************************/
+
+	// the statuses above only hold what is certain, these feed
+	// the exact pit and wumpus probabilities; MyAI itself only uses them
+	// as a safety prover, entering a grid once its risk is exactly 0,
+	// which the status rules alone cannot always show; a grid at any risk
+	// is at least one in five to kill, the pit prior, and entering such
+	// grids lost score on fresh worlds, so real risks are left to SearchAI
+	// every percept updates them incrementally, touching only the grids
+	// and constraints it affects
+
+	// one constraint per breezy grid: at least one of its neighbors that
+	// is not PITSAFE holds a pit, the constraint is ACTIVE until a PITCERTAIN
+	// neighbor satisfies it; grids and constraints are stored in the board
+	// breezyGrids  every breezy grid, i.e. every constraint
+	vector<pair<int, int>> breezyGrids;
+
+	// the grids consistent with every stench, scream and missed arrow so far
+	// the live wumpus is equally likely in each of them
+	// only known from the first stench on: the wumpus is next to it,
+	// so there are at most 4; once it is dead, the ones it could have died in
+	// on the bitboards, wumpusCandBits is narrowed from the start by every
+	// visit, and only read from the first stench on
+	bool wumpusCandKnown;
+	bool wumpusDead;
+	Bitboard wumpusCandBits;
+	int numWumpusCand;
+	pair<int, int> wumpusCand[4];
+
+	// the grids and constraints of one connected component of the frontier,
+	// found by a component search, see Grid::mark
+	// components larger than MAXENUMERATE are not enumerated
+	static const int MAXENUMERATE = 24;
+	unsigned markStamp;
+	vector<pair<int, int>> compGrids;
+	vector<pair<int, int>> compClauses;
+	vector<pair<int, int>> compStack;
+	// the unvisited grids next to a visited one
+	vector<pair<int, int>> frontier;
 	
 	/*******************************
  	 * Subsection: helper functions 	
@@ -122,93 +289,206 @@ private:
 
 	// get legal neighbors of a grid (not limited to current grid)
 	// (r, c) is the zero-based position of the grid
-	// return: vector of neighbor positions, each in the form of (row, col) 
-	vector<pair<int, int>> getNeighbors(int r, int c);
+	// nbs: filled with neighbor positions, each in the form of (row, col)
+	// return: number of neighbors, at most 4
+	int getNeighbors(int r, int c, pair<int, int> nbs[4]);
 
 	// update dungeon info according to the sensors
 	void updateBoard(bool st, bool br, bool gl, bool bp, bool sc);
 
+	// narrow the wumpus candidates by the percepts of the current grid
+	// nbs, numNbs: the neighbors of the current grid
+	void updateWumpusCand(bool st, bool sc, pair<int, int> nbs[4], int numNbs);
+
+	// update status of the current grid's neighbors according to the percepts
+	// nbs, numNbs: the neighbors of the current grid
+	void updateNeighbors(bool st, bool br, pair<int, int> nbs[4], int numNbs);
+
+	// the choice once no safe grid is left and the arrow is not going to be shot:
+	// step into an unvisited grid, or go back and climb out
+	// the default only enters a grid proven safe
+	// return: the first action of the plan
+	virtual Action chooseRiskOrEscape();
+
+	// plan a route into a grid next to a visited one
+	// return: the first action of the plan
+	Action takeRisk(int r, int c);
+
+	// plan the route to the entrance and the CLIMB
+	// return: the first action of the plan
+	Action escape();
+
+	// a grid of the store, (r, c) must be inside capR x capC
+	Grid& at(int r, int c) { return board[r * capC + c]; }
+
+	// the bitboard of a single grid of the corner
+	static Bitboard gridBit(int r, int c) { return 1ULL << (r * BITSIZE + c); }
+
+	// all legal neighbors of a set of grids, by shifting the set in 4 directions
+	Bitboard expand(Bitboard grids);
+
+	// move the statuses from the bitboards to the store, and the
+	// wumpus candidates to wumpusCand, for the rest of the game
+	void leaveBitboards();
+
+	// true if (r, c) is inside the actual size of the dungeon
+	bool isInside(int r, int c) { return r >= 0 && c >= 0 && r < sizeR && c < sizeC; }
+
+	// make grids (0,0) to (r, c) part of the store, growing it if needed
+	void reserveBoard(int r, int c);
 
+	// shrink the dungeon after bumping into a wall
+	// the grids beyond it are set unmovable and can hold no pit
+	void resizeBoard(int rows, int cols);
 
-	// transform a queue of route into a queue of actions
+	// the status of a grid, (r, c) must be inside capR x capC
+	Status getStatus(int r, int c);
+
+	// move a grid to the given status
+	void setStatus(int r, int c, Status status);
+
+	// on the bitboards, move a set of grids to the given status
+	void setStatus(Bitboard grids, Status status);
+
+
+
+	// transform a route into qActions, replacing its content
 	// route:  a step-to-step route from current position to dest
 	// finalDir: the direction agent will face after executing the series of actions
 	// escape: if it is true, a CLIMB will be attached at the end of the queue
-	// return: a queue of actions transformed from the route
-	queue<Action> routeToActions(queue<pair<int, int>> route, 
-									int& finalDir, bool escape);
+	void routeToActions(const Route& route, int& finalDir, bool escape);
 
 	// helper function for routeToActions
 	// add intermidiate TURN_LEFT/RIGHT between FORWARD
 	// curDir:  curDir%4 represents direction
 	// tarDir:  0(N),1(E),2(S),3(W)
-	// return:  one of 4 cases -- empty, TURN_LEFT, TURN_RIGHT, (TURN_LEFT, TURN_LEFT)
-	vector<Action> makeTurns(int curDir, int tarDir);
+	// appends one of 4 cases to qActions --
+	// nothing, TURN_LEFT, TURN_RIGHT, (TURN_LEFT, TURN_LEFT)
+	void makeTurns(int curDir, int tarDir);
 
 
 	// generate a route from current position to destination
-	// backtracking heuristic path-finding algorithm:
 	// the route only pass through visited grids
-	// from valid frontier of each movement, 
-	// it choose the one that is closest to the dest
-	// backtrack when no more movement in frontier
+	// and takes the fewest actions, turns included
+	// (destR, destC): position of destination, visited or next to a visited grid
+	// route: filled with the grids towards to the destination
+	void generateRoute(int destR, int destC, Route& route);
+
+	// on the bitboards, generateRoute() by following the distance cache
+	void followCache(int destR, int destC, Route& route);
+
+	// add a newly visited grid to the distance cache
+	// a route through it can be shorter, so every row goes stale
+	// (r, c): position of the grid
+	void addRoutable(int r, int c);
+
+	// fill a row of the distance cache by a breadth first search
+	// a: the cached state the row starts from
+	void fillRow(int a);
+
+	// the cheapest cached state to end a route to the destination in
+	// the destination itself if it is routable, otherwise
+	// a routable neighbor facing it, one FORWARD away
+	// on a tie, the lowest facing direction
+	// (destR, destC): position of destination
+	// cost: set to the number of actions needed to reach the destination
+	// return: the end state, -1 if the destination cannot be reached
+	int getCachedEndState(int destR, int destC, int& cost);
+
+	// cached distance between two states of routable grids,
+	// filling the row of the first one if it is stale
+	int getCachedDistance(int from, int to);
+
+	// breadth first search from the current state over visited grids
+	// goal(state) is called on every state reached, in order of distance;
+	// the search stops after the first layer of equal distance
+	// in which it returned true
+	template <typename Goal>
+	void search(Goal goal);
+
+	// actions from the current state to a state, as found by the last search
+	// return: INT_MAX if the search did not reach it
+	int getStateDistance(int state);
+
+	// the cheapest state to end a route to the destination in
+	// the destination itself if it is visited, otherwise
+	// a visited neighbor facing it, one FORWARD away
+	// on a tie, the lowest facing direction
 	// (destR, destC): position of destination
-	// return: a queue of grids towards to the destination
-	queue<pair<int, int>> generateRoute(int destR, int destC);
-
-	// BT route generator
-	// src: starting grid
-	// dest: destination
-	// board: grids status, is a local copy of grids
-	// routeToDest: the route from src to dest (solution)
-	// routeSoFar: route found so far
-	// found: stop BTS when a route to dest is found
-	void generateRouteHelper (
-					pair<int, int> src, 
-					pair<int, int> dest,
-					vector<vector<int>>& board,
-					vector<pair<int, int>>& routeToDest,
-					vector<pair<int, int>>& routeSoFar,
-					bool& found);
-						
-
-	// helper function of route generator
-	// frontier is defined as all neighbors of status 1(visited) and not on the route
-	// board:  represents the route, status 9 means on the route
-	// return: frontier of src, paired with each's distance to dest
-	vector<pair<pair<int, int>, int>> getFrontier(
-					pair<int, int> src, 
-					pair<int, int> dest);
-
-	// customer comparator for route generator
-	// argument: a.first is the grid 1, a.second is its distance to destination
-	// argument: b.first is the grid 2, b.second is its distance to destination
-	// return:  a.second <= b.second, sort by distance to destination
-	static bool compare(pair<pair<int, int>, int> a, pair<pair<int, int>, int> b);
-
- 
-	// retrive all grids labeled as explorable
-	// return: a vector of grids in the form of (row, col)
-	vector<pair<int, int>> getExplorable();	
-
-	// from a set of grids, return the nearest one to the current grid
-	// cand: candidate grids to pick
-	// return: (row, col) of the nearest grid
-	pair<int, int> getNearestGrid(vector<pair<int, int>> cand);
-
-	// calculate the squared distance between current grid and the target grid
+	// return: the end state, -1 if the destination cannot be reached
+	int getEndState(int destR, int destC);
+
+	// fill route with the grids from the current state to the end state
+	// of the last search, then the destination if it is not visited
+	void traceRoute(int endState, int destR, int destC, Route& route);
+
+	// the nearest explorable grid, the first one row by row on a tie
+	// dest: set to the grid
+	// route: filled with the grids towards it
+	void getNearestGrid(pair<int, int>& dest, Route& route);
+
+	// calculate the number of actions from the current state to the target grid
+	// from the cache, or off the bitboards, as found by the last search,
+	// which must have reached every state
 	// (r, c): position of target grid
-	// return: distance b/w two grids
+	// return: distance b/w two grids, INT_MAX if unreachable
 	int getDistance(int r, int c);
 
 	// update board status when the position of wumpus is locked
 	// (r, c): the position of wumpus
-	// set all grids that are labeled "wumpus" to "explorable"
+	// set all other grids that are labeled "wumpus" to "explorable"
 	void lockWumpus(int r, int c);
 
 
+	/*******************************
+ 	 * Subsection: probabilistic inference
+	 *******************************/
+
+	// add the constraint of a breezy grid
+	// (r, c): position of the grid
+	void addPitClause(int r, int c);
+
+	// a grid proven pit free leaves the constraints of its breezy neighbors,
+	// a constraint left with one grid proves that grid a pit
+	void markPitSafe(int r, int c);
+
+	// a certain pit satisfies every constraint of its breezy neighbors
+	void markPit(int r, int c);
+
+	// recheck the constraint of a breezy grid after one of its grids
+	// was proven pit free
+	void updatePitClause(int r, int c);
+
+	// mark the grids of a constraint DIRTY, after it changed
+	void touchPitClause(int r, int c);
+
+	// bring the pit probability of every frontier grid up to date
+	// pits are independent with prior PITPRIOR, so every connected
+	// component of the active constraints is enumerated on its own,
+	// and only again once one of its grids is DIRTY
+	void inferPits();
+
+	// exact pit probabilities of the component in compGrids and compClauses
+	// stored in the pitProb of its grids
+	void enumeratePits();
+
+	// the probability of a pit in a grid inside the dungeon, after inferPits()
+	double getPitProb(int r, int c);
+
+	// true if a grid is one of the wumpus candidates, once they are known
+	bool inWumpusCand(int r, int c);
+
+	// the probability of the live wumpus in a grid
+	// the wumpus is equally likely in every grid consistent with the stenches
+	double getWumpusProb(int r, int c);
+
+	// pick the least deadly unvisited grid next to a visited one
+	// dest: set to the grid
+	// return: true if it is proven free of pits and of the live wumpus
+	bool getProvenSafe(pair<int, int>& dest);
+
 	// for debug use
-	void printActionQueue(queue<Action> q);
+	void printActionQueue(const ActionPlan& q);
 
 };
 
@@ -0,0 +1,62 @@
+// ======================================================================
+// FILE:        Parallel.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains parallelFor, the worker pool shared by
+//              the tournament and the simulator. Every worker claims the
+//              next unclaimed chunk of indices until none are left, so
+//              slow games do not hold up the other workers.
+//
+// NOTES:       - The task is called as task ( worker, index ), where
+//                worker is in [0, numOfThreads) and identifies the
+//                calling thread, so tasks can keep per-worker state.
+//
+//              - A task returns false to stop the whole loop early.
+// ======================================================================
+
+#ifndef PARALLEL_LOCK
+#define PARALLEL_LOCK
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+template <typename Task>
+void parallelFor ( size_t count, unsigned numOfThreads, const Task &task, size_t chunkSize = 1 )
+{
+	std::atomic<size_t>	nextIndex ( 0 );
+	std::atomic<bool>	stopped ( false );
+
+	auto worker = [&] ( unsigned workerIndex )
+	{
+		while ( !stopped )
+		{
+			size_t first = nextIndex.fetch_add ( chunkSize );
+			if ( first >= count )
+				return;
+
+			size_t last = first + chunkSize < count ? first + chunkSize : count;
+			for ( size_t index = first; index < last; ++index )
+				if ( !task ( workerIndex, index ) )
+				{
+					stopped = true;
+					return;
+				}
+		}
+	};
+
+	if ( numOfThreads == 0 )
+		numOfThreads = 1;
+
+	// The calling thread is worker 0
+	std::vector<std::thread> workers;
+	for ( unsigned workerIndex = 1; workerIndex < numOfThreads; ++workerIndex )
+		workers.push_back ( std::thread ( worker, workerIndex ) );
+	worker ( 0 );
+	for ( std::thread &t : workers )
+		t.join();
+}
+
+#endif /* PARALLEL_LOCK */
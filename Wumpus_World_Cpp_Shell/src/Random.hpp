@@ -0,0 +1,57 @@
+// ======================================================================
+// FILE:        Random.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the random number generator used by
+//              the World and the RandomAI. Every object owns its own
+//              generator state, so games never share a generator and a
+//              game can be replayed from its seed.
+//
+// NOTES:       - The generator is SplitMix64, which is small, fast and
+//                passes BigCrush. It is not meant for cryptography.
+// ======================================================================
+
+#ifndef RANDOM_LOCK
+#define RANDOM_LOCK
+
+#include <cstdint>
+
+class Random
+{
+public:
+
+	Random ( uint64_t seed = 0 ) : state ( seed ) {}
+
+	// Returns the next 64 random bits
+	uint64_t next ( void )
+	{
+		return mix ( state += 0x9E3779B97F4A7C15ULL );
+	}
+
+	// Randomly generate a int in the range [0, limit)
+	int randomInt ( int limit )
+	{
+		return (int)( next() % (uint64_t)limit );
+	}
+
+	// Derives an independent seed for the given stream of a seed,
+	// e.g. one stream for the world and one for its agent
+	static uint64_t deriveSeed ( uint64_t seed, uint64_t stream )
+	{
+		return mix ( seed ^ mix ( stream + 0x9E3779B97F4A7C15ULL ) );
+	}
+
+private:
+
+	uint64_t state;
+
+	static uint64_t mix ( uint64_t z )
+	{
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+		return z ^ ( z >> 31 );
+	}
+};
+
+#endif /* RANDOM_LOCK */
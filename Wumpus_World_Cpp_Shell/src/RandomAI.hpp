@@ -9,19 +9,25 @@
 //              exception. If the agent perceives glitter, it will grab
 //              the gold.
 //
-// NOTES:       - Don't make changes to this file.
+// NOTES:       - The RandomAI owns its generator, seeded by the World,
+//                so its moves can be replayed from the game's seed.
+//
+//              - Don't make changes to this file.
 // ======================================================================
 
 #ifndef RANDOMAI_LOCK
 #define RANDOMAI_LOCK
 
-#include <cstdlib>
+#include <cstdint>
 #include "Agent.hpp"
+#include "Random.hpp"
 
 class RandomAI : public Agent
 {
 public:
 
+	RandomAI ( uint64_t seed = 0 ) : rng ( seed ) {}
+
 	Action getAction
 	(
 		bool stench,
@@ -34,11 +40,18 @@ public:
 		if ( glitter )
 			return GRAB;
 		
-		return actions [ rand() % 6 ];
+		return actions [ rng.randomInt ( 6 ) ];
+	}
+	
+	void reset ( uint64_t seed )
+	{
+		rng = Random ( seed );
 	}
 	
 private:
 
+	Random rng;
+
 	const Action actions[6] =
 	{
 		TURN_LEFT,
@@ -0,0 +1,64 @@
+// ======================================================================
+// FILE:        ReplayAI.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the replay agent class, which
+//              implements the agent interface. The ReplayAI plays the
+//              actions of a trace, from any of its steps, so a World can
+//              show a recorded game move by move in debug mode.
+//
+// NOTES:       - The World has to be restored to the state of the trace
+//                at that step first, see Trace::seek.
+//
+//              - Past the last step of the trace it climbs.
+// ======================================================================
+
+#ifndef REPLAYAI_LOCK
+#define REPLAYAI_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include "Agent.hpp"
+#include "Trace.hpp"
+
+class ReplayAI : public Agent
+{
+public:
+
+	ReplayAI ( void ) : trace ( nullptr ), step ( 0 ) {}
+
+	// Plays trace from step on
+	void start ( const Trace *_trace, size_t _step )
+	{
+		trace = _trace;
+		step  = _step;
+	}
+
+	Action getAction
+	(
+		bool stench,
+		bool breeze,
+		bool glitter,
+		bool bump,
+		bool scream
+	)
+	{
+		if ( trace == nullptr || step >= trace->size() )
+			return CLIMB;
+
+		return trace->getAction ( step++ );
+	}
+
+	void reset ( uint64_t seed )
+	{
+		step = 0;
+	}
+
+private:
+
+	const Trace	*trace;		// The game played, not owned
+	size_t		step;		// The next step played
+};
+
+#endif
@@ -0,0 +1,98 @@
+// ======================================================================
+// FILE:        RingBuffer.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains a FIFO queue over a circular array.
+//              It replaces std::queue where the same queue is filled
+//              and drained over and over. The first CAPACITY items are
+//              stored inline in the owner, so a queue that never holds
+//              more never allocates. Past that the items move to the
+//              heap, into an array that doubles when a push finds it
+//              full, so once it has reached the largest size needed,
+//              pushing and popping never allocate either.
+//
+// NOTES:       - Growing moves the items to the front of the new array,
+//                so the order of the items is kept.
+// ======================================================================
+
+#ifndef RINGBUFFER_LOCK
+#define RINGBUFFER_LOCK
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+template <typename T, int CAPACITY>
+class RingBuffer
+{
+public:
+
+	RingBuffer ( void ) : head ( 0 ), count ( 0 ) {}
+
+	bool	empty		( void ) const { return count == 0; }
+	int		size		( void ) const { return count; }
+	int		capacity	( void ) const { return spilled.empty() ? CAPACITY : spilled.size(); }
+
+	// Adds an item at the back
+	void push ( T item )
+	{
+		if ( count == capacity() )
+			grow();
+		items()[( head + count++ ) % capacity()] = std::move ( item );
+	}
+
+	// The item at the front
+	T&			front	( void )		{ return items()[head]; }
+	const T&	front	( void ) const	{ return items()[head]; }
+
+	// The i-th item from the front
+	const T&	operator[]	( int i ) const	{ return items()[( head + i ) % capacity()]; }
+
+	// Removes the item at the front
+	void pop ( void )
+	{
+		assert ( !empty() );
+		head = ( head + 1 ) % capacity();
+		--count;
+	}
+
+	// Removes and returns the item at the front
+	T take ( void )
+	{
+		T item = std::move ( front() );
+		pop();
+		return item;
+	}
+
+	// Empties the buffer, keeping its memory
+	void clear ( void )
+	{
+		head = 0;
+		count = 0;
+	}
+
+private:
+
+	// The array in use, the inline one until the first growth; found on
+	// every access rather than kept, so the default copy stays correct
+	T*			items	( void )		{ return spilled.empty() ? inlined : spilled.data(); }
+	const T*	items	( void ) const	{ return spilled.empty() ? inlined : spilled.data(); }
+
+	// Doubles the array, the front item moves to index 0
+	void grow ( void )
+	{
+		std::vector<T> larger ( capacity() * 2 );
+		for ( int i = 0; i < count; ++i )
+			larger[i] = std::move ( items()[( head + i ) % capacity()] );
+		spilled.swap ( larger );
+		head = 0;
+	}
+
+	T				inlined[CAPACITY];
+	std::vector<T>	spilled;	// The heap array, empty until the first growth
+	int				head;		// Index of the front item
+	int				count;		// Number of items in the buffer
+};
+
+#endif /* RINGBUFFER_LOCK */
@@ -0,0 +1,71 @@
+// ======================================================================
+// FILE:        RolloutState.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the state of a rollout, a game the
+//              search agent plays out in a sampled world. It is a
+//              GameState with the board inside the struct instead of on
+//              the heap, so a rollout is set up by a copy or a reset and
+//              stepped by the same Rules as the World.
+//
+// NOTES:       - A game can start anywhere in it: reset() lays out the
+//                board, then the agent variables are set to the point
+//                the search starts from.
+//
+//              - Boards hold at most MAX_TILES tiles, as many as an
+//                8x8 board of the corpus. Check fits() first, larger
+//                boards need a GameState.
+// ======================================================================
+
+#ifndef ROLLOUTSTATE_LOCK
+#define ROLLOUTSTATE_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "Rules.hpp"
+#include "WorldSpec.hpp"
+
+struct RolloutState
+{
+	static const int	MAX_TILES = 64;
+
+	// Board Variables, as in GameState
+	size_t	colDimension;
+	size_t	rowDimension;
+	uint8_t	board[MAX_TILES];	// One byte of Rules::TileFlags per tile, column after column
+
+	// Agent Variables, as in GameState
+	int		score;
+	bool	goldLooted;
+	bool	hasArrow;
+	bool	bump;
+	bool	scream;
+	size_t	agentDir;			// 0 - right, 1 - down, 2 - left, 3 - up
+	size_t	agentX;
+	size_t	agentY;
+
+	static bool	fits	( int cols, int rows ) { return cols > 0 && rows > 0 && cols * rows <= MAX_TILES; }
+
+	uint8_t&	tile	( size_t c, size_t r )       { return board[c * rowDimension + r]; }
+	uint8_t		tile	( size_t c, size_t r ) const { return board[c * rowDimension + r]; }
+
+	// Lays out the board of spec, which must fit, and puts the agent
+	// at (0,0) facing right with a full score, as GameState::reset does
+	void reset ( const WorldSpec &spec )
+	{
+		colDimension = spec.colDimension;
+		rowDimension = spec.rowDimension;
+		memset ( board, 0, colDimension * rowDimension );
+		Rules::addFeatures ( *this, spec );
+		Rules::resetAgent ( *this );
+	}
+
+	// Percepts of the agent's tile
+	bool	stench	( void ) const { return tile ( agentX, agentY ) & Rules::STENCH; }
+	bool	breeze	( void ) const { return tile ( agentX, agentY ) & Rules::BREEZE; }
+	bool	glitter	( void ) const { return tile ( agentX, agentY ) & Rules::GOLD; }
+};
+
+#endif /* ROLLOUTSTATE_LOCK */
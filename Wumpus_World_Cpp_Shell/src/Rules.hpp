@@ -0,0 +1,231 @@
+// ======================================================================
+// FILE:        Rules.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the rules of the game, taken out of
+//              World::run so that every engine plays by the same code:
+//              how features are placed, how an action moves the agent,
+//              shoots the arrow, grabs the gold or climbs out, and what
+//              it scores.
+//
+// NOTES:       - The rules work on any game state that has the members
+//                below, named as in World:
+//
+//                  colDimension, rowDimension   the board size
+//                  tile ( c, r )                the TileFlags of a tile,
+//                                               as a reference
+//                  score, goldLooted, hasArrow,
+//                  bump, scream,
+//                  agentDir, agentX, agentY     the agent
+//
+//              - Directions are 0 - right, 1 - down, 2 - left, 3 - up,
+//                and a FORWARD facing down decreases agentY.
+// ======================================================================
+
+#ifndef RULES_LOCK
+#define RULES_LOCK
+
+#include <cstddef>
+#include <cstdint>
+#include "Agent.hpp"
+#include "WorldSpec.hpp"
+
+struct Rules
+{
+	// Tile Flags, a tile is one byte holding any combination of these
+	enum TileFlag
+	{
+		PIT    = 1 << 0,
+		WUMPUS = 1 << 1,
+		GOLD   = 1 << 2,
+		BREEZE = 1 << 3,
+		STENCH = 1 << 4
+	};
+
+	// ===============================================================
+	// =					Board Setup
+	// ===============================================================
+
+	// Puts the agent at (0,0) facing right, with its arrow and a full score
+	template <typename State>
+	static void resetAgent ( State &state )
+	{
+		state.score      = 0;
+		state.goldLooted = false;
+		state.hasArrow   = true;
+		state.bump       = false;
+		state.scream     = false;
+		state.agentDir   = 0;
+		state.agentX     = 0;
+		state.agentY     = 0;
+	}
+
+	// Lays out the features of spec on an empty board of its size
+	template <typename State>
+	static void addFeatures ( State &state, const WorldSpec &spec )
+	{
+		addWumpus ( state, spec.wumpusC, spec.wumpusR );
+		addGold ( state, spec.goldC, spec.goldR );
+		for ( size_t index = 0; index < spec.pits.size(); ++index )
+			addPit ( state, spec.pits[index].first, spec.pits[index].second );
+	}
+
+	// Features outside the board are ignored
+	template <typename State>
+	static void addPit ( State &state, size_t c, size_t r )
+	{
+		if ( isInBounds ( state, c, r ) )
+		{
+			state.tile ( c, r ) |= PIT;
+			addFlag ( state, c+1, r, BREEZE );
+			addFlag ( state, c-1, r, BREEZE );
+			addFlag ( state, c, r+1, BREEZE );
+			addFlag ( state, c, r-1, BREEZE );
+		}
+	}
+
+	template <typename State>
+	static void addWumpus ( State &state, size_t c, size_t r )
+	{
+		if ( isInBounds ( state, c, r ) )
+		{
+			state.tile ( c, r ) |= WUMPUS;
+			addFlag ( state, c+1, r, STENCH );
+			addFlag ( state, c-1, r, STENCH );
+			addFlag ( state, c, r+1, STENCH );
+			addFlag ( state, c, r-1, STENCH );
+		}
+	}
+
+	template <typename State>
+	static void addGold ( State &state, size_t c, size_t r )
+	{
+		addFlag ( state, c, r, GOLD );
+	}
+
+	// A dead wumpus leaves its stench in its tile
+	template <typename State>
+	static void killWumpus ( State &state, size_t c, size_t r )
+	{
+		state.tile ( c, r ) &= ~WUMPUS;
+		state.tile ( c, r ) |= STENCH;
+	}
+
+	template <typename State>
+	static bool isInBounds ( const State &state, size_t c, size_t r )
+	{
+		return ( c < state.colDimension && r < state.rowDimension );
+	}
+
+	// ===============================================================
+	// =					Engine Function
+	// ===============================================================
+
+	// Makes the move, returns true if it ended the game
+	template <typename State>
+	static bool step ( State &state, Agent::Action action )
+	{
+		--state.score;
+		state.bump   = false;
+		state.scream = false;
+
+		switch ( action )
+		{
+			case Agent::TURN_LEFT:
+				if (--state.agentDir > 3) state.agentDir = 3;	// This works because size_t is unsigned
+				break;
+
+			case Agent::TURN_RIGHT:
+				if (++state.agentDir > 3) state.agentDir = 0;
+				break;
+
+			case Agent::FORWARD:
+				if ( state.agentDir == 0 && state.agentX+1 < state.colDimension )
+					++state.agentX;
+				else if ( state.agentDir == 1 && state.agentY-1 < state.rowDimension ) // This still works because size_t
+					--state.agentY;
+				else if ( state.agentDir == 2 && state.agentX-1 < state.colDimension ) // gets big, instead of going negative
+					--state.agentX;
+				else if ( state.agentDir == 3 && state.agentY+1 < state.rowDimension )
+					++state.agentY;
+				else
+					state.bump = true;
+
+				if ( state.tile ( state.agentX, state.agentY ) & ( PIT | WUMPUS ) )
+				{
+					state.score -= 1000;
+					return true;
+				}
+				break;
+
+			case Agent::SHOOT:
+				if ( state.hasArrow )
+				{
+					state.hasArrow = false;
+					state.score -= 10;
+					if ( state.agentDir == 0 )
+					{
+						for ( size_t x = state.agentX; x < state.colDimension; ++x )
+							shootAt ( state, x, state.agentY );
+					}
+					else if ( state.agentDir == 1 )
+					{
+						for ( size_t y = state.agentY; y < state.rowDimension; --y )
+							shootAt ( state, state.agentX, y );
+					}
+					else if ( state.agentDir == 2 )
+					{
+						for ( size_t x = state.agentX; x < state.colDimension; --x )
+							shootAt ( state, x, state.agentY );
+					}
+					else if ( state.agentDir == 3 )
+					{
+						for ( size_t y = state.agentY; y < state.rowDimension; ++y )
+							shootAt ( state, state.agentX, y );
+					}
+				}
+				break;
+
+			case Agent::GRAB:
+				if ( state.tile ( state.agentX, state.agentY ) & GOLD )
+				{
+					state.tile ( state.agentX, state.agentY ) &= ~GOLD;
+					state.goldLooted = true;
+				}
+				break;
+
+			case Agent::CLIMB:
+				if ( state.agentX == 0 && state.agentY == 0 )
+				{
+					if ( state.goldLooted )
+						state.score += 1000;
+					return true;
+				}
+				break;
+		}
+		return false;
+	}
+
+private:
+
+	template <typename State>
+	static void addFlag ( State &state, size_t c, size_t r, uint8_t flag )
+	{
+		if ( isInBounds ( state, c, r ) )
+			state.tile ( c, r ) |= flag;
+	}
+
+	// The arrow flies on through the tile, killing the wumpus if it is there
+	template <typename State>
+	static void shootAt ( State &state, size_t c, size_t r )
+	{
+		if ( state.tile ( c, r ) & WUMPUS )
+		{
+			killWumpus ( state, c, r );
+			state.scream = true;
+		}
+	}
+};
+
+#endif /* RULES_LOCK */
@@ -0,0 +1,496 @@
+// ======================================================================
+// FILE:        SearchAI.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the search agent, see SearchAI.hpp.
+//
+// NOTES:       - A rollout plays by the Rules of the World, on a copy
+//                of a RolloutState, or of a GameState for boards too
+//                large for it, that starts where the agent is now.
+// ======================================================================
+
+#include "SearchAI.hpp"
+
+#include <chrono>
+#include <cmath>
+#include "Parallel.hpp"
+
+int			SearchAI::budgetMs		= 10;
+unsigned	SearchAI::numOfThreads	= 1;
+const int	SearchAI::DIMLOW;
+const int	SearchAI::DIMHIGH;
+const double	SearchAI::SIGNIFICANCE	= 2;
+
+// the pit prior of the world generator, and how often a draw is
+// repeated before the last one is kept
+static const int PITODDS = 5;
+static const int MAXTRIES = 1000;
+
+// ===============================================================
+// =				Rollouts
+// ===============================================================
+
+// MyAI, opened up so the option can be taken on its behalf
+struct SearchAI::Policy : public MyAI
+{
+	using MyAI::takeRisk;
+	using MyAI::escape;
+	Policy& operator= ( const MyAI& ai ) { MyAI::operator= ( ai ); return *this; }
+};
+
+struct SearchAI::Worker
+{
+	Policy			policy;		// MyAI as it was when the option was taken
+	WorldSpec		spec;
+	vector<char>	pits;
+	// the sampled world with the agent where it is now, and the copy of it
+	// an option is played on; in a GameState if it is too large to fit
+	RolloutState	base;
+	RolloutState	state;
+	GameState		largeBase;
+	GameState		largeState;
+	// per option, the sum and the sum of squares of its score less the score
+	// of climbing out in the same sampled world, and the number of samples
+	int				escapeScore;
+	double			sums[MAXOPTIONS + 1];
+	double			squares[MAXOPTIONS + 1];
+	int				counts[MAXOPTIONS + 1];
+};
+
+template <typename State>
+void SearchAI::startRollouts ( const WorldSpec& spec, State& base )
+{
+	// the World was counting down the score from 0 by one per action
+	// and 10 for the arrow; numOfActions already counts the action being
+	// decided, which Rules::step charges when the rollout plays it
+	base.reset ( spec );
+	base.agentX   = curC;
+	base.agentY   = curR;
+	base.agentDir = ( dir + 3 ) % 4;
+	base.hasArrow = canShoot;
+	base.score    = -( numOfActions - 1 ) - ( canShoot ? 0 : 10 );
+	if ( wumpusDead )
+		Rules::killWumpus ( base, spec.wumpusC, spec.wumpusR );
+}
+
+template <typename State>
+int SearchAI::rollout ( Policy& policy, State& state, const State& base, pair<int, int> option )
+{
+	// the option, then MyAI from what it knows now, as World::run plays
+	state  = base;
+	policy = *this;
+	Action action = option.first < 0 ? policy.escape() : policy.takeRisk ( option.first, option.second );
+	while ( !Rules::step ( state, action ) && state.score >= -1000 )
+		action = policy.getAction ( state.stench(), state.breeze(), state.glitter(), state.bump, state.scream );
+	return state.score;
+}
+
+// ===============================================================
+// =				Agent
+// ===============================================================
+
+SearchAI::SearchAI ( void ) : budget ( budgetMs ), numOfActions ( 0 ), gameSeed ( 0 ), numOfSearches ( 0 ) {}
+
+SearchAI::SearchAI ( int _budget ) : budget ( _budget ), numOfActions ( 0 ), gameSeed ( 0 ), numOfSearches ( 0 ) {}
+
+SearchAI::~SearchAI ( void ) {}
+
+Agent::Action SearchAI::getAction ( bool stench, bool breeze, bool glitter, bool bump, bool scream )
+{
+	++numOfActions;
+	return MyAI::getAction ( stench, breeze, glitter, bump, scream );
+}
+
+void SearchAI::reset ( uint64_t seed )
+{
+	MyAI::reset ( seed );
+	numOfActions  = 0;
+	gameSeed      = seed;
+	numOfSearches = 0;
+}
+
+Agent::Action SearchAI::chooseRiskOrEscape ( void )
+{
+	// a grid proven safe needs no search
+	pair<int, int> dest;
+	if ( getProvenSafe ( dest ) )
+		return takeRisk ( dest.first, dest.second );
+
+	// the options: climbing out, and the least risky reachable frontier grids,
+	// getProvenSafe() left the frontier and every distance behind
+	auto risk = [this] ( const pair<int, int>& grid )
+	{
+		return 1 - ( 1 - getPitProb ( grid.first, grid.second ) ) * ( 1 - getWumpusProb ( grid.first, grid.second ) );
+	};
+	options.clear();
+	for ( size_t k = 0; k < frontier.size(); ++k )
+		if ( getDistance ( frontier[k].first, frontier[k].second ) != INT_MAX && risk ( frontier[k] ) < 1 )
+			options.push_back ( frontier[k] );
+	if ( options.empty() )
+		return escape();
+	stable_sort ( options.begin(), options.end(), [&] ( const pair<int, int>& a, const pair<int, int>& b )
+	{
+		return risk ( a ) < risk ( b );
+	} );
+	if ( options.size() > (size_t)MAXOPTIONS )
+		options.resize ( MAXOPTIONS );
+	options.insert ( options.begin(), make_pair ( -1, -1 ) );
+
+	// the largest board sampled decides where the rollouts are played
+	prepareSampling();
+	bool fits = RolloutState::fits ( dimensions.back().second, dimensions.back().first );
+
+	unsigned threads = numOfThreads > 0 ? numOfThreads : 1;
+	while ( workers.size() < threads )
+		workers.push_back ( unique_ptr<Worker> ( new Worker() ) );
+	size_t numOptions = options.size();
+	for ( unsigned w = 0; w < threads; ++w )
+		for ( size_t k = 0; k < numOptions; ++k )
+		{
+			workers[w]->sums[k]    = 0;
+			workers[w]->squares[k] = 0;
+			workers[w]->counts[k]  = 0;
+		}
+
+	// every sample is one chunk, so each sampled world is set up once
+	// and played with every option
+	uint64_t searchSeed = Random::deriveSeed ( gameSeed, ++numOfSearches );
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds ( budget );
+	parallelFor ( numOptions * MAXSAMPLES, threads, [&] ( unsigned w, size_t index )
+	{
+		size_t sample = index / numOptions;
+		size_t k      = index % numOptions;
+		if ( k == 0 && sample >= (size_t)MINROLLOUTS && chrono::steady_clock::now() > deadline )
+			return false;
+
+		Worker& worker = *workers[w];
+		if ( k == 0 )
+		{
+			Random rng ( Random::deriveSeed ( searchSeed, sample ) );
+			sampleWorld ( rng, worker.spec, worker.pits );
+			if ( fits )
+				startRollouts ( worker.spec, worker.base );
+			else
+				startRollouts ( worker.spec, worker.largeBase );
+		}
+
+		int score = fits ? rollout ( worker.policy, worker.state, worker.base, options[k] )
+		                 : rollout ( worker.policy, worker.largeState, worker.largeBase, options[k] );
+		if ( k == 0 )
+			worker.escapeScore = score;
+		double gain = score - worker.escapeScore;
+		worker.sums[k]    += gain;
+		worker.squares[k] += gain * gain;
+		++worker.counts[k];
+		return true;
+	}, numOptions );
+
+	// the largest mean gain over climbing out, counting only gains that are
+	// SIGNIFICANCE standard errors clear of zero: with hundreds of samples
+	// the best of several noisy means is too good to be true otherwise
+	size_t best = 0;
+	double bestGain = 0;
+	for ( size_t k = 1; k < numOptions; ++k )
+	{
+		double sum = 0;
+		double squares = 0;
+		int count = 0;
+		for ( unsigned w = 0; w < threads; ++w )
+		{
+			sum     += workers[w]->sums[k];
+			squares += workers[w]->squares[k];
+			count   += workers[w]->counts[k];
+		}
+		double mean = sum / count;
+		double error = sqrt ( max ( 0.0, squares / count - mean * mean ) / count );
+
+		#ifdef DEBUG
+		cout << "option " << options[k].first << "," << options[k].second
+			 << ": " << mean << " +- " << error << " over " << count << endl;
+		#endif
+
+		if ( mean - SIGNIFICANCE * error > 0 && mean > bestGain )
+		{
+			bestGain = mean;
+			best = k;
+		}
+	}
+
+	if ( best == 0 )
+		return escape();
+	return takeRisk ( options[best].first, options[best].second );
+}
+
+// ===============================================================
+// =				Sampling
+// ===============================================================
+
+void SearchAI::prepareSampling ( void )
+{
+	// the visited grids bound the dimensions from below
+	int minRows = DIMLOW;
+	int minCols = DIMLOW;
+	for ( size_t k = 0; k < visitedGrids.size(); ++k )
+	{
+		minRows = max ( minRows, visitedGrids[k].first + 1 );
+		minCols = max ( minCols, visitedGrids[k].second + 1 );
+	}
+	int maxRows = sizeR != INT_MAX ? sizeR : max ( DIMHIGH, minRows );
+	int maxCols = sizeC != INT_MAX ? sizeC : max ( DIMHIGH, minCols );
+	if ( sizeR != INT_MAX )
+		minRows = sizeR;
+	if ( sizeC != INT_MAX )
+		minCols = sizeC;
+
+	// the active constraints, with the grids they name
+	pitCells.clear();
+	rawClauses.clear();
+	for ( size_t k = 0; k < breezyGrids.size(); ++k )
+	{
+		int r = breezyGrids[k].first;
+		int c = breezyGrids[k].second;
+		if ( !( at ( r, c ).flags & ACTIVE ) )
+			continue;
+		pair<int, int> nbs[4];
+		int numNbs = getNeighbors ( r, c, nbs );
+		int n = 0;
+		for ( int i = 0; i < numNbs; ++i )
+			if ( !( knownFlags ( nbs[i].first, nbs[i].second ) & PITSAFE ) )
+			{
+				rawClauses.push_back ( nbs[i] );
+				pitCells.push_back ( nbs[i] );
+				++n;
+			}
+		// a wall found later can leave a constraint with no grid, the percepts
+		// then contradict each other and it is dropped, as addPitClause() does
+		if ( n == 0 )
+			continue;
+		for ( ; n < 4; ++n )
+			rawClauses.push_back ( make_pair ( -1, -1 ) );
+	}
+	sort ( pitCells.begin(), pitCells.end() );
+	pitCells.erase ( unique ( pitCells.begin(), pitCells.end() ), pitCells.end() );
+
+	wumpusCells.clear();
+	for ( int r = 0; r < maxRows; ++r )
+		for ( int c = 0; c < maxCols; ++c )
+			if ( ( r != 0 || c != 0 ) && isWumpusCand ( r, c ) )
+				wumpusCells.push_back ( make_pair ( r, c ) );
+
+	// every dimension is equally likely up front, and the wumpus and the gold are
+	// each in one of the rows*cols-1 grids but (0,0), so the percepts weigh a
+	// dimension by the share of grids left to the wumpus times the share left
+	// to the gold, the grids that were not visited
+	dimensions.clear();
+	dimWeights.clear();
+	double sum = 0;
+	for ( int rows = minRows; rows <= maxRows; ++rows )
+		for ( int cols = minCols; cols <= maxCols; ++cols )
+		{
+			int numCells = rows * cols - 1;
+			int numWumpus = 0;
+			for ( size_t k = 0; k < wumpusCells.size(); ++k )
+				if ( wumpusCells[k].first < rows && wumpusCells[k].second < cols )
+					++numWumpus;
+			// the percepts contradict each other, the wumpus is put anywhere
+			if ( wumpusCells.empty() )
+				numWumpus = 1;
+			// every breeze needs a grid inside that can hold its pit,
+			// a certain pit included
+			for ( size_t k = 0; k < breezyGrids.size() && numWumpus > 0; ++k )
+			{
+				pair<int, int> nbs[4];
+				int numNbs = getNeighbors ( breezyGrids[k].first, breezyGrids[k].second, nbs );
+				bool inside = false;
+				for ( int i = 0; i < numNbs; ++i )
+					if ( nbs[i].first < rows && nbs[i].second < cols && !( knownFlags ( nbs[i].first, nbs[i].second ) & PITSAFE ) )
+						inside = true;
+				if ( !inside )
+					numWumpus = 0;
+			}
+			sum += (double)numWumpus / numCells * ( numCells + 1 - (double)visitedGrids.size() ) / numCells;
+			dimensions.push_back ( make_pair ( rows, cols ) );
+			dimWeights.push_back ( sum );
+		}
+
+	// the constraints as indices into pitCells, and the grids of each
+	// constraint joined into one component
+	int numCells = pitCells.size();
+	int numClauses = rawClauses.size() / 4;
+	clauseCells.resize ( rawClauses.size() );
+	cellComp.resize ( numCells );
+	for ( int i = 0; i < numCells; ++i )
+		cellComp[i] = i;
+	auto find = [this] ( int i )
+	{
+		while ( cellComp[i] != i )
+			i = cellComp[i] = cellComp[cellComp[i]];
+		return i;
+	};
+	for ( int j = 0; j < numClauses; ++j )
+		for ( int i = 0; i < 4; ++i )
+		{
+			pair<int, int> grid = rawClauses[j * 4 + i];
+			clauseCells[j * 4 + i] = grid.first < 0 ? -1 : lower_bound ( pitCells.begin(), pitCells.end(), grid ) - pitCells.begin();
+			if ( i > 0 && grid.first >= 0 )
+				cellComp[find ( clauseCells[j * 4 + i] )] = find ( clauseCells[j * 4] );
+		}
+
+	// number the components in the order of their roots, then sort
+	// the grids and the constraints by component
+	int numComps = 0;
+	compCellList.assign ( numCells, -1 );
+	for ( int i = 0; i < numCells; ++i )
+		if ( find ( i ) == i )
+			compCellList[i] = numComps++;
+	for ( int i = 0; i < numCells; ++i )
+		cellComp[i] = find ( i );
+	for ( int i = 0; i < numCells; ++i )
+		cellComp[i] = compCellList[cellComp[i]];
+
+	compCellStart.assign ( numComps + 1, 0 );
+	for ( int i = 0; i < numCells; ++i )
+		++compCellStart[cellComp[i] + 1];
+	for ( int k = 0; k < numComps; ++k )
+		compCellStart[k + 1] += compCellStart[k];
+	for ( int i = 0; i < numCells; ++i )
+		compCellList[compCellStart[cellComp[i]]++] = i;
+	for ( int k = numComps; k > 0; --k )
+		compCellStart[k] = compCellStart[k - 1];
+	compCellStart[0] = 0;
+
+	// the constraints are few, so they are sorted in place
+	compClauseStart.assign ( numComps + 1, 0 );
+	for ( int j = 0; j < numClauses; ++j )
+		++compClauseStart[cellComp[clauseCells[j * 4]] + 1];
+	for ( int k = 0; k < numComps; ++k )
+		compClauseStart[k + 1] += compClauseStart[k];
+	for ( int j = 1; j < numClauses; ++j )
+		for ( int i = j; i > 0 && cellComp[clauseCells[i * 4]] < cellComp[clauseCells[( i - 1 ) * 4]]; --i )
+			swap_ranges ( clauseCells.begin() + i * 4, clauseCells.begin() + i * 4 + 4, clauseCells.begin() + ( i - 1 ) * 4 );
+}
+
+void SearchAI::sampleWorld ( Random& rng, WorldSpec& spec, vector<char>& pits )
+{
+	int numComps = compCellStart.size() - 1;
+	pits.resize ( pitCells.size() );
+
+	double weight = rng.next() / 18446744073709551616.0 * dimWeights.back();
+	size_t pick = upper_bound ( dimWeights.begin(), dimWeights.end(), weight ) - dimWeights.begin();
+	int rows = dimensions[min ( pick, dimensions.size() - 1 )].first;
+	int cols = dimensions[min ( pick, dimensions.size() - 1 )].second;
+
+	// the wumpus: one of its grids inside
+	spec.wumpusR = rows - 1;
+	spec.wumpusC = cols - 1;
+	int numWumpus = 0;
+	for ( size_t k = 0; k < wumpusCells.size(); ++k )
+		if ( wumpusCells[k].first < rows && wumpusCells[k].second < cols )
+			++numWumpus;
+	int index = numWumpus > 0 ? rng.randomInt ( numWumpus ) : -1;
+	for ( size_t k = 0; k < wumpusCells.size() && index >= 0; ++k )
+		if ( wumpusCells[k].first < rows && wumpusCells[k].second < cols && index-- == 0 )
+		{
+			spec.wumpusR = wumpusCells[k].first;
+			spec.wumpusC = wumpusCells[k].second;
+		}
+
+	// the gold: anywhere but (0,0) and where no glitter was sensed
+	for ( int tries = 1; ; ++tries )
+	{
+		int cell = 1 + rng.randomInt ( rows * cols - 1 );
+		spec.goldR = cell / cols;
+		spec.goldC = cell % cols;
+		if ( tries == MAXTRIES || knownStatus ( spec.goldR, spec.goldC ) != VISITED )
+			break;
+	}
+
+	// the constrained grids one component at a time, all over again until
+	// every constraint has a pit, on the last try the first grid
+	// of each unsatisfied constraint is made a pit
+	for ( int k = 0; k < numComps; ++k )
+		for ( int tries = 1; ; ++tries )
+		{
+			for ( int n = compCellStart[k]; n < compCellStart[k + 1]; ++n )
+			{
+				int i = compCellList[n];
+				pits[i] = pitCells[i].first < rows && pitCells[i].second < cols && rng.randomInt ( PITODDS ) == 0;
+			}
+			bool satisfied = true;
+			for ( int j = compClauseStart[k]; j < compClauseStart[k + 1]; ++j )
+			{
+				int first = -1;
+				bool holds = false;
+				for ( int n = 0; n < 4 && clauseCells[j * 4 + n] >= 0; ++n )
+				{
+					int i = clauseCells[j * 4 + n];
+					holds = holds || pits[i];
+					if ( first < 0 && pitCells[i].first < rows && pitCells[i].second < cols )
+						first = i;
+				}
+				if ( holds )
+					continue;
+				satisfied = false;
+				if ( tries == MAXTRIES && first >= 0 )
+					pits[first] = 1;
+			}
+			if ( satisfied || tries == MAXTRIES )
+				break;
+		}
+
+	spec.rowDimension = rows;
+	spec.colDimension = cols;
+	spec.pits.clear();
+	for ( size_t i = 0; i < pitCells.size(); ++i )
+		if ( pits[i] )
+			spec.pits.push_back ( make_pair ( pitCells[i].second, pitCells[i].first ) );
+
+	// every other grid: what is certain, otherwise the prior
+	for ( int r = 0; r < rows; ++r )
+		for ( int c = 0; c < cols; ++c )
+		{
+			if ( r == 0 && c == 0 )
+				continue;
+			unsigned char flags = knownFlags ( r, c );
+			if ( knownStatus ( r, c ) == VISITED || ( flags & PITSAFE ) )
+				continue;
+			if ( flags & PITCERTAIN )
+			{
+				spec.pits.push_back ( make_pair ( c, r ) );
+				continue;
+			}
+			if ( binary_search ( pitCells.begin(), pitCells.end(), make_pair ( r, c ) ) )
+				continue;
+			if ( rng.randomInt ( PITODDS ) == 0 )
+				spec.pits.push_back ( make_pair ( c, r ) );
+		}
+}
+
+unsigned char SearchAI::knownFlags ( int r, int c )
+{
+	return r < capR && c < capC ? at ( r, c ).flags : 0;
+}
+
+MyAI::Status SearchAI::knownStatus ( int r, int c )
+{
+	return r < capR && c < capC ? getStatus ( r, c ) : UNKNOWN;
+}
+
+bool SearchAI::isWumpusCand ( int r, int c )
+{
+	// from the first stench on, one of the candidates, dead or alive
+	if ( wumpusCandKnown && !inWumpusCand ( r, c ) )
+		return false;
+	// a stench in exactly the visited grids next to it,
+	// its own grid can only have been visited once it was dead
+	if ( knownStatus ( r, c ) == VISITED && !wumpusDead )
+		return false;
+	for ( size_t k = 0; k < visitedGrids.size(); ++k )
+	{
+		int dist = abs ( visitedGrids[k].first - r ) + abs ( visitedGrids[k].second - c );
+		if ( dist > 0 && ( dist == 1 ) != ( ( at ( visitedGrids[k].first, visitedGrids[k].second ).flags & STENCH ) != 0 ) )
+			return false;
+	}
+	return true;
+}
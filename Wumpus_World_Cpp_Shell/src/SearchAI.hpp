@@ -0,0 +1,165 @@
+// ======================================================================
+// FILE:        SearchAI.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the search agent, MyAI with a lookahead
+//              for the one decision MyAI takes blindly: what to do once
+//              nothing safe is left to explore. MyAI then climbs out,
+//              unless a grid is all but proven safe. The search agent
+//              weighs climbing out against stepping into each unvisited
+//              grid next to a visited one, by Monte Carlo rollouts:
+//
+//              - a rollout samples a complete world consistent with all
+//                that was sensed so far, puts the agent in it where it
+//                is now, takes the option, and lets MyAI play the rest;
+//
+//              - every option is played on the same sampled worlds, so
+//                they are compared on equal luck, and the grid with the
+//                best mean gain over climbing out is taken, if the gain
+//                is clear of the sampling noise.
+//
+// NOTES:       - The rollouts of a decision run on numOfThreads threads
+//                until budgetMs milliseconds have passed, but at least
+//                MINROLLOUTS times per option. A search agent takes the
+//                budget given when it is made, budgetMs by default, so
+//                two agents can search for different times; the threads
+//                are shared by every search agent. Set them before a
+//                game starts.
+//
+//              - How many rollouts fit in the budget depends on the
+//                machine and its load, so games are only replayed
+//                exactly when MINROLLOUTS is reached first.
+//
+//              - It does not measurably beat MyAI. Against MyAI on the
+//                same generated worlds (-c, -gN s3) the gain per game
+//                was -0.11 +- 0.59 over 64000 worlds with -a0, and
+//                0.64 +- 2.35 over 8000 with -a2, 95% intervals. The
+//                options it weighs are rarely worth taking: a grid at
+//                any risk is at least one in five to kill, and a
+//                rollout never takes a second risk.
+// ======================================================================
+
+#ifndef SEARCHAI_LOCK
+#define SEARCHAI_LOCK
+
+#include <memory>
+#include <vector>
+#include "MyAI.hpp"
+#include "GameState.hpp"
+#include "Random.hpp"
+#include "RolloutState.hpp"
+#include "WorldSpec.hpp"
+
+class SearchAI : public MyAI
+{
+public:
+	SearchAI ( void );
+	explicit SearchAI ( int budget );
+	~SearchAI ( void );
+
+	Action getAction
+	(
+		bool stench,
+		bool breeze,
+		bool glitter,
+		bool bump,
+		bool scream
+	);
+
+	void reset(uint64_t seed);
+
+	// milliseconds of rollouts per decision of new agents, and threads
+	// running them
+	static int budgetMs;
+	static unsigned numOfThreads;
+
+private:
+	// the fewest rollouts of each option, whatever the budget
+	static const int MINROLLOUTS = 32;
+	// the most sampled worlds of a decision
+	static const int MAXSAMPLES = 1 << 20;
+	// at most this many grids are weighed, the least risky ones
+	static const int MAXOPTIONS = 6;
+	// standard errors a gain must clear to be taken
+	static const double SIGNIFICANCE;
+	// an unknown dimension is drawn uniformly from this range,
+	// the sizes of the generated worlds, raised to what was explored
+	static const int DIMLOW = 4;
+	static const int DIMHIGH = 7;
+
+	// MyAI, taking an option then playing the rest of a rollout
+	// from what it knew when the option was taken
+	struct Policy;
+
+	// what a rollout thread keeps between rollouts
+	struct Worker;
+	vector<unique_ptr<Worker>> workers;
+
+	// milliseconds of rollouts per decision of this agent
+	int budget;
+
+	// the number of actions taken in this game, for the score so far
+	int numOfActions;
+	// the game's seed and the number of searches so far, seeding the samples
+	uint64_t gameSeed;
+	int numOfSearches;
+
+	// the options of the current decision, (-1, -1) is climbing out
+	vector<pair<int, int>> options;
+
+	/*******************************
+ 	 * Subsection: sampling
+	 *******************************/
+
+	// the grids of the active pit constraints, sorted, and the constraints
+	// as 4 indices into it each, -1 padded, grouped by connected component:
+	// component k has grids compCellList[compCellStart[k] .. compCellStart[k+1]-1]
+	// and constraints compClauseStart[k] .. compClauseStart[k+1]-1 of clauseCells
+	vector<pair<int, int>> pitCells;
+	vector<int> compCellStart;
+	vector<int> compCellList;
+	vector<int> compClauseStart;
+	vector<int> clauseCells;
+	// scratch space: the grids of each constraint in the order found,
+	// 4 each, (-1, -1) padded, and each grid's component
+	vector<pair<int, int>> rawClauses;
+	vector<int> cellComp;
+	// the grids the wumpus could be in, and the dimensions the dungeon
+	// could have with the running sum of their posterior weights
+	vector<pair<int, int>> wumpusCells;
+	vector<pair<int, int>> dimensions;
+	vector<double> dimWeights;
+
+	// search: the first action of the best option
+	Action chooseRiskOrEscape();
+
+	// set base up as the world of spec with the agent where it is now
+	template <typename State>
+	void startRollouts(const WorldSpec& spec, State& base);
+
+	// play a copy of base in state, taking the option first, (-1, -1) is
+	// climbing out, then letting policy play MyAI from the current state
+	// return: the final score
+	template <typename State>
+	int rollout(Policy& policy, State& state, const State& base, pair<int, int> option);
+
+	// gather what sampleWorld() needs, once per decision
+	void prepareSampling();
+
+	// fill spec with a world drawn from the posterior of the percepts so far:
+	// the dimensions are drawn by how many places they leave the wumpus and
+	// the gold, then those, then the pits of each component all over again
+	// until every constraint holds; the other pits cannot change a percept
+	// pits: one flag per grid of pitCells, scratch space
+	void sampleWorld(Random& rng, WorldSpec& spec, vector<char>& pits);
+
+	// what is known about a grid, unknown beyond the store
+	unsigned char knownFlags(int r, int c);
+	Status knownStatus(int r, int c);
+
+	// true if the wumpus could be in (r, c), as far as the percepts tell
+	bool isWumpusCand(int r, int c);
+};
+
+#endif
@@ -0,0 +1,44 @@
+// ======================================================================
+// FILE:        Simulator.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the simulator class, the library
+//              interface for playing many in-memory worlds.
+// ======================================================================
+
+#include "Simulator.hpp"
+#include "Parallel.hpp"
+
+using namespace std;
+
+// ===============================================================
+// =						Constructor
+// ===============================================================
+
+Simulator::Simulator ( const AgentFactory &factory, unsigned numOfThreads )
+{
+	if ( numOfThreads == 0 )
+		numOfThreads = 1;
+
+	for ( unsigned index = 0; index < numOfThreads; ++index )
+	{
+		agents.push_back ( unique_ptr<Agent> ( factory() ) );
+		worlds.push_back ( unique_ptr<World> ( new World ( agents.back().get() ) ) );
+	}
+}
+
+// ===============================================================
+// =					Simulation Function
+// ===============================================================
+
+void Simulator::simulateBatch ( const WorldSpec *specs, size_t count, int *scores, uint64_t seed )
+{
+	parallelFor ( count, worlds.size(), [&] ( unsigned worker, size_t index )
+	{
+		World &world = *worlds[worker];
+		world.reset ( specs[index], seed+index );
+		scores[index] = world.run();
+		return true;
+	}, 64 );
+}
@@ -0,0 +1,51 @@
+// ======================================================================
+// FILE:        Simulator.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the simulator class, the library
+//              interface for playing many in-memory worlds. Unlike the
+//              tournament, it never touches the file system and never
+//              allocates per game: every worker thread owns one agent
+//              and one World, which are reset for each game and kept
+//              for the lifetime of the simulator.
+//
+// NOTES:       - Usage:
+//
+//                  Simulator sim ( [] () { return new MyAI(); }, 4 );
+//                  sim.simulateBatch ( specs, count, scores, seed );
+//
+//              - specs[i] is played with seed+i, the same seeding as
+//                the tournament, and its score is written to scores[i].
+// ======================================================================
+
+#ifndef SIMULATOR_LOCK
+#define SIMULATOR_LOCK
+
+#include<cstdint>
+#include<memory>
+#include<vector>
+#include"AgentFactory.hpp"
+#include"World.hpp"
+#include"WorldSpec.hpp"
+
+class Simulator
+{
+public:
+
+	// Constructor, creates one agent and one World per thread
+	Simulator ( const AgentFactory &factory, unsigned numOfThreads = 1 );
+
+	// Plays specs[0..count), writing the scores to scores[0..count)
+	void	simulateBatch	( const WorldSpec *specs, size_t count, int *scores, uint64_t seed = 0 );
+
+private:
+
+	Simulator ( const Simulator& ) = delete;
+	Simulator& operator= ( const Simulator& ) = delete;
+
+	std::vector<std::unique_ptr<Agent>>	agents;		// One agent per worker, reused for every game
+	std::vector<std::unique_ptr<World>>	worlds;		// One World per worker, reused for every game
+};
+
+#endif /* SIMULATOR_LOCK */
@@ -0,0 +1,427 @@
+// ======================================================================
+// FILE:        Tournament.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the tournament class, which plays a
+//              list of world files, a packed corpus, or a stream of
+//              freshly generated worlds, and accumulates the agent's
+//              scores, or the differences of its scores from a baseline's.
+// ======================================================================
+
+#include "Tournament.hpp"
+
+#include "BoundedQueue.hpp"
+#include "Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+static const size_t	FIRST_LOOK = 100;	// Worlds played by the first look of a comparison
+
+// The z with a standard normal probability p below it, by bisection
+static double normalQuantile ( double p )
+{
+	double low  = -40;
+	double high = 40;
+	for ( int iteration = 0; iteration < 200; ++iteration )
+	{
+		double middle = ( low + high ) / 2;
+		if ( 0.5 * erfc ( -middle / sqrt ( 2.0 ) ) < p )
+			low = middle;
+		else
+			high = middle;
+	}
+	return ( low + high ) / 2;
+}
+
+// ===============================================================
+// =						Constructor
+// ===============================================================
+
+Tournament::Tournament ( bool _debug, bool _randomAI, bool _manualAI, bool _verbose, unsigned _numOfThreads, uint64_t _seed, bool _searchAI )
+{
+	debug        = _debug;
+	randomAI     = _randomAI;
+	manualAI     = _manualAI;
+	searchAI     = _searchAI;
+	verbose      = _verbose;
+	numOfThreads = _numOfThreads;
+	seed         = _seed;
+	lossFile     = nullptr;
+	comparing    = false;
+	confidence   = 0.95;
+
+	// The console can only be shared by one game at a time
+	if ( numOfThreads == 0 || debug || manualAI )
+		numOfThreads = 1;
+
+	numOfScores        = 0;
+	sumOfScores        = 0;
+	sumOfScoresSquared = 0;
+	comparison         = Comparison();
+}
+
+// ===============================================================
+// =						Run Functions
+// ===============================================================
+
+bool Tournament::run ( const string &folder, const vector<string> &worldNames )
+{
+	return play ( worldNames.size(), [&] ( size_t index, WorldSpec &spec )
+	{
+		try
+		{
+			spec.read ( "./" + folder + "/" + worldNames[index] );
+		}
+		catch (...)
+		{
+			return false;
+		}
+		return true;
+	}, &worldNames );
+}
+
+bool Tournament::run ( const Corpus &corpus )
+{
+	return play ( corpus.size(), [&] ( size_t index, WorldSpec &spec )
+	{
+		corpus.get ( index, spec );
+		return true;
+	}, nullptr );
+}
+
+bool Tournament::play ( size_t numOfWorlds, const WorldLoader &load, const vector<string> *worldNames )
+{
+	if ( comparing )
+		return playPaired ( numOfWorlds, load, worldNames );
+
+	vector<int>		scores ( numOfWorlds, 0 );
+	atomic<bool>	failed ( false );
+	mutex			outputLock;
+
+	unsigned numOfWorkers = numOfThreads;
+	if ( numOfWorkers > numOfWorlds )
+		numOfWorkers = numOfWorlds > 0 ? numOfWorlds : 1;
+
+	// Every worker reuses one agent, World and spec for all its games
+	vector<unique_ptr<Agent>>	agents;
+	vector<unique_ptr<World>>	worlds;
+	vector<Trace>				traces ( numOfWorkers );
+	vector<WorldSpec>			specs ( numOfWorkers );
+	makeWorkers ( numOfWorkers, agents, worlds, traces );
+
+	parallelFor ( numOfWorlds, numOfWorkers, [&] ( unsigned worker, size_t index )
+	{
+		if ( verbose )
+		{
+			lock_guard<mutex> guard ( outputLock );
+			cout << "Running world: ";
+			if ( worldNames )
+				cout << ( *worldNames )[index];
+			else
+				cout << "#" << index;
+			cout << ", seed: " << seed+index << endl;
+		}
+
+		if ( !load ( index, specs[worker] ) )
+		{
+			failed = true;
+			return false;
+		}
+
+		worlds[worker]->reset ( specs[worker], seed+index );
+		scores[index] = worlds[worker]->run();
+		archive ( traces[worker], scores[index] );
+		return true;
+	} );
+
+	numOfScores        = 0;
+	sumOfScores        = 0;
+	sumOfScoresSquared = 0;
+
+	if ( failed )
+		return false;
+
+	// Reduce in list order, so the sums are identical for any thread count
+	for ( size_t index = 0; index < numOfWorlds; ++index )
+	{
+		numOfScores += 1;
+		sumOfScores += scores[index];
+		sumOfScoresSquared += scores[index]*scores[index];
+	}
+	return true;
+}
+
+bool Tournament::runGenerated ( size_t numOfWorlds )
+{
+	// Looks need every world by index, which generateWorld gives alone
+	if ( comparing )
+		return playPaired ( numOfWorlds, [this] ( size_t index, WorldSpec &spec )
+		{
+			generateWorld ( seed, index, spec );
+			return true;
+		}, nullptr );
+
+	// A generated world, tagged with its index for the seed
+	struct Item
+	{
+		size_t		index;
+		WorldSpec	spec;
+	};
+
+	// A worker's partial sums; integer sums are exact, so they add up
+	// the same in any order. The vector gives no 64-byte alignment, so
+	// each is padded to 128 bytes: two workers' sums are then at least
+	// 112 bytes apart, and never on the same cache line
+	struct Sums
+	{
+		int64_t	sumOfScores;
+		int64_t	sumOfScoresSquared;
+		char	pad[112];
+	};
+
+	unsigned numOfWorkers = numOfThreads;
+	if ( numOfWorkers > numOfWorlds )
+		numOfWorkers = numOfWorlds > 0 ? numOfWorlds : 1;
+
+	vector<unique_ptr<Agent>>	agents;
+	vector<unique_ptr<World>>	worlds;
+	vector<Trace>				traces ( numOfWorkers );
+	vector<Item>				items ( numOfWorkers );
+	vector<Sums>				sums ( numOfWorkers, Sums() );
+	BoundedQueue<Item>			queue ( 1024 );
+	mutex						outputLock;
+	makeWorkers ( numOfWorkers, agents, worlds, traces );
+
+	// The producer stays ahead of the workers by up to the queue's capacity
+	thread producer ( [&] ()
+	{
+		Item item;
+		for ( size_t index = 0; index < numOfWorlds; ++index )
+		{
+			item.index = index;
+			generateWorld ( seed, index, item.spec );
+			while ( !queue.tryPush ( item ) )
+				this_thread::yield();
+		}
+	} );
+
+	// Every task pops one world, whichever the producer made next
+	parallelFor ( numOfWorlds, numOfWorkers, [&] ( unsigned worker, size_t )
+	{
+		Item &item = items[worker];
+		while ( !queue.tryPop ( item ) )
+			this_thread::yield();
+
+		if ( verbose )
+		{
+			lock_guard<mutex> guard ( outputLock );
+			cout << "Running world: #" << item.index << " (" << item.spec.colDimension << "x"
+				 << item.spec.rowDimension << "), seed: " << seed+item.index << endl;
+		}
+
+		worlds[worker]->reset ( item.spec, seed+item.index );
+		int64_t score = worlds[worker]->run();
+		archive ( traces[worker], score );
+		sums[worker].sumOfScores += score;
+		sums[worker].sumOfScoresSquared += score*score;
+		return true;
+	}, 64 );
+
+	producer.join();
+
+	numOfScores        = numOfWorlds;
+	sumOfScores        = 0;
+	sumOfScoresSquared = 0;
+	for ( unsigned worker = 0; worker < numOfWorkers; ++worker )
+	{
+		sumOfScores += sums[worker].sumOfScores;
+		sumOfScoresSquared += sums[worker].sumOfScoresSquared;
+	}
+	return true;
+}
+
+bool Tournament::playPaired ( size_t numOfWorlds, const WorldLoader &load, const vector<string> *worldNames )
+{
+	vector<int>		scores ( numOfWorlds, 0 );
+	vector<int>		baseScores ( numOfWorlds, 0 );
+	atomic<bool>	failed ( false );
+	mutex			outputLock;
+
+	unsigned numOfWorkers = numOfThreads;
+	if ( numOfWorkers > numOfWorlds )
+		numOfWorkers = numOfWorlds > 0 ? numOfWorlds : 1;
+
+	// Every worker plays the agent and the baseline in Worlds of their own
+	vector<unique_ptr<Agent>>	agents;
+	vector<unique_ptr<World>>	worlds;
+	vector<unique_ptr<Agent>>	baseAgents;
+	vector<unique_ptr<World>>	baseWorlds;
+	vector<Trace>				traces ( numOfWorkers );
+	vector<WorldSpec>			specs ( numOfWorkers );
+	makeWorkers ( numOfWorkers, agents, worlds, traces );
+	for ( unsigned worker = 0; worker < numOfWorkers; ++worker )
+	{
+		baseAgents.push_back ( unique_ptr<Agent> ( baseline() ) );
+		baseWorlds.push_back ( unique_ptr<World> ( new World ( baseAgents.back().get(), debug, false ) ) );
+	}
+
+	// Every look there could be shares the error rate evenly
+	comparison = Comparison();
+	for ( size_t end = 0; end < numOfWorlds; end = min ( numOfWorlds, end > 0 ? 2*end : FIRST_LOOK ) )
+		++comparison.maxLooks;
+	double z = normalQuantile ( 1 - ( 1 - confidence ) / ( 2 * max ( comparison.maxLooks, 1 ) ) );
+
+	numOfScores        = 0;
+	sumOfScores        = 0;
+	sumOfScoresSquared = 0;
+
+	double	sumOfDifferences        = 0;
+	double	sumOfDifferencesSquared = 0;
+	size_t	start = 0;
+
+	while ( start < numOfWorlds && !comparison.decided )
+	{
+		size_t end = min ( numOfWorlds, start > 0 ? 2*start : FIRST_LOOK );
+
+		parallelFor ( end - start, numOfWorkers, [&] ( unsigned worker, size_t task )
+		{
+			size_t index = start + task;
+			if ( verbose )
+			{
+				lock_guard<mutex> guard ( outputLock );
+				cout << "Running world: ";
+				if ( worldNames )
+					cout << ( *worldNames )[index];
+				else
+					cout << "#" << index;
+				cout << ", seed: " << seed+index << endl;
+			}
+
+			if ( !load ( index, specs[worker] ) )
+			{
+				failed = true;
+				return false;
+			}
+
+			// Both agents get the same world and the same seed
+			baseWorlds[worker]->reset ( specs[worker], seed+index );
+			baseScores[index] = baseWorlds[worker]->run();
+			worlds[worker]->reset ( specs[worker], seed+index );
+			scores[index] = worlds[worker]->run();
+			archive ( traces[worker], scores[index] );
+			return true;
+		} );
+
+		if ( failed )
+		{
+			numOfScores = 0;
+			return false;
+		}
+
+		// Reduce in list order, so the look is identical for any thread count
+		for ( size_t index = start; index < end; ++index )
+		{
+			double difference = scores[index] - baseScores[index];
+			numOfScores += 1;
+			sumOfScores += scores[index];
+			sumOfScoresSquared += (double)scores[index]*scores[index];
+			comparison.sumOfBaseline += baseScores[index];
+			sumOfDifferences += difference;
+			sumOfDifferencesSquared += difference*difference;
+		}
+
+		double mean     = sumOfDifferences / numOfScores;
+		double variance = numOfScores > 1 ? ( sumOfDifferencesSquared - numOfScores*mean*mean ) / ( numOfScores-1 ) : 0;
+
+		comparison.numOfLooks    += 1;
+		comparison.meanDifference = mean;
+		comparison.halfWidth      = z * sqrt ( max ( variance, 0.0 ) / numOfScores );
+		comparison.decided        = numOfScores > 1 && fabs ( mean ) > comparison.halfWidth;
+		start = end;
+	}
+	return true;
+}
+
+void Tournament::generateWorld ( uint64_t seed, size_t index, WorldSpec &spec )
+{
+	// Stream 2 of the world's seed, after the World's and the agent's
+	Random rng ( Random::deriveSeed ( seed+index, 2 ) );
+	int cols = 4 + rng.randomInt ( 4 );
+	int rows = 4 + rng.randomInt ( 4 );
+	spec.generate ( rng, cols, rows );
+}
+
+void Tournament::archiveLosses ( ostream *file )
+{
+	lossFile = file;
+}
+
+void Tournament::compareWith ( const AgentFactory &_baseline, double _confidence )
+{
+	comparing  = true;
+	baseline   = _baseline;
+	confidence = _confidence;
+}
+
+// ===============================================================
+// =						Worker Functions
+// ===============================================================
+
+void Tournament::makeWorkers ( unsigned numOfWorkers, vector<unique_ptr<Agent>> &agents, vector<unique_ptr<World>> &worlds, vector<Trace> &traces )
+{
+	for ( unsigned index = 0; index < numOfWorkers; ++index )
+	{
+		agents.push_back ( unique_ptr<Agent> ( World::newAgent ( randomAI, manualAI, searchAI ) ) );
+		worlds.push_back ( unique_ptr<World> ( new World ( agents.back().get(), debug, manualAI ) ) );
+		if ( lossFile )
+			worlds.back()->setTrace ( &traces[index] );
+	}
+}
+
+void Tournament::archive ( const Trace &trace, int score )
+{
+	if ( lossFile && score < -1000 )
+	{
+		// A failed write leaves lossFile failed, for the caller to check
+		lock_guard<mutex> guard ( lossLock );
+		try
+		{
+			trace.write ( *lossFile );
+		}
+		catch (...)
+		{
+		}
+	}
+}
+
+// ===============================================================
+// =						Result Functions
+// ===============================================================
+
+int Tournament::getNumOfScores ( void ) const
+{
+	return numOfScores;
+}
+
+double Tournament::getSumOfScores ( void ) const
+{
+	return sumOfScores;
+}
+
+double Tournament::getSumOfScoresSquared ( void ) const
+{
+	return sumOfScoresSquared;
+}
+
+const Tournament::Comparison& Tournament::getComparison ( void ) const
+{
+	return comparison;
+}
@@ -0,0 +1,146 @@
+// ======================================================================
+// FILE:        Tournament.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the tournament class, which plays a
+//              list of world files, a packed corpus, or a stream of
+//              freshly generated worlds, and accumulates the agent's
+//              scores.
+//              The worlds are sharded across a pool of worker threads;
+//              each worker resets its own agent and World for every
+//              world it plays, and the scores are reduced in list order
+//              once every worker has finished, so the result does not
+//              depend on the number of threads or on the order in which
+//              the workers finish.
+//
+// NOTES:       - Debug mode and the ManualAI read from the console, so
+//                they always run on a single thread.
+//
+//              - The i-th world in the list is played with seed+i, so
+//                any game of a tournament can be replayed on its own.
+//
+//              - Lost games can be archived as traces, a game is lost if
+//                the agent died or ran out of score, which both end it
+//                below -1000. Only the file order of the traces depends
+//                on the threads.
+//
+//              - In a comparison every world is played twice, by a
+//                baseline agent and by the agent, with the same seed, so
+//                the difference of their scores on a world is down to
+//                the agents alone. Both must be built into this program;
+//                two builds of an agent cannot be compared directly.
+//                The worlds are played in looks of 100, 200, 400, ...
+//                worlds in all, and the comparison stops at the first
+//                look whose confidence interval of the mean difference
+//                leaves out 0. Each look is taken at the confidence
+//                level split evenly over every look there could be
+//                (Bonferroni), so stopping early keeps the stated level.
+//
+//              - Generated worlds come from a producer thread through a
+//                bounded lock-free queue, so the workers never touch the
+//                file system. The i-th world is generated from seed+i
+//                alone, so the result does not depend on the number of
+//                threads either.
+// ======================================================================
+
+#ifndef TOURNAMENT_LOCK
+#define TOURNAMENT_LOCK
+
+#include<string>
+#include<vector>
+#include<cstdint>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<ostream>
+#include"AgentFactory.hpp"
+#include"Corpus.hpp"
+#include"Trace.hpp"
+#include"World.hpp"
+
+class Tournament
+{
+public:
+
+	// Constructor
+	Tournament ( bool debug = false, bool randomAI = false, bool manualAI = false, bool verbose = false, unsigned numOfThreads = 1, uint64_t seed = 0, bool searchAI = false );
+
+	// Plays every world in folder/worldNames, returns false if a world failed to load
+	bool	run	( const std::string &folder, const std::vector<std::string> &worldNames );
+
+	// Plays every world in corpus
+	bool	run	( const Corpus &corpus );
+
+	// Plays numOfWorlds random worlds of 4x4 to 7x7, generated while playing
+	bool	runGenerated	( size_t numOfWorlds );
+
+	// Fills spec with the index-th generated world of seed
+	static void	generateWorld	( uint64_t seed, size_t index, WorldSpec &spec );
+	
+	// Writes the trace of every game lost in the next runs to file, whose
+	// header must be written, or none if nullptr
+	void	archiveLosses	( std::ostream *file );
+
+	// Plays every world of the next runs by an agent of baseline too, and
+	// stops as soon as the agent and the baseline differ at the given
+	// confidence
+	void	compareWith	( const AgentFactory &baseline, double confidence = 0.95 );
+
+	// The paired result of the last run, if comparing
+	struct Comparison
+	{
+		int		numOfLooks;			// Looks taken
+		int		maxLooks;			// Looks there would be on every world
+		double	sumOfBaseline;		// Sum of the baseline's scores
+		double	meanDifference;		// Mean of the agent's score minus the baseline's
+		double	halfWidth;			// Of the confidence interval of meanDifference
+		bool	decided;			// True if the interval leaves out 0
+	};
+
+	// Results of the last run, of the agent when comparing
+	int		getNumOfScores			( void ) const;
+	double	getSumOfScores			( void ) const;
+	double	getSumOfScoresSquared	( void ) const;
+	const Comparison&	getComparison	( void ) const;
+
+private:
+
+	// Fills spec with the index-th world, returns false if it failed to load
+	typedef std::function<bool ( size_t index, WorldSpec &spec )> WorldLoader;
+
+	// Plays worlds [0, numOfWorlds), worldNames is only used for verbose output
+	bool	play	( size_t numOfWorlds, const WorldLoader &load, const std::vector<std::string> *worldNames );
+
+	// Plays worlds [0, numOfWorlds) by the baseline and the agent, in looks
+	bool	playPaired	( size_t numOfWorlds, const WorldLoader &load, const std::vector<std::string> *worldNames );
+
+	// Creates one agent and one World for each of numOfWorkers workers,
+	// each World recording into a trace of its own if losses are archived
+	void	makeWorkers	( unsigned numOfWorkers, std::vector<std::unique_ptr<Agent>> &agents, std::vector<std::unique_ptr<World>> &worlds, std::vector<Trace> &traces );
+	
+	// Archives the worker's last game if it was lost
+	void	archive	( const Trace &trace, int score );
+
+	// Operation Variables
+	bool		debug;			// Passed on to every World
+	bool		randomAI;		// Passed on to every World
+	bool		manualAI;		// Passed on to every World
+	bool		searchAI;		// Passed on to every World
+	bool		verbose;		// If true, displays world file names before loading them
+	unsigned	numOfThreads;	// The number of worker threads
+	uint64_t	seed;			// Seed of the first world, the i-th world gets seed+i
+	std::ostream	*lossFile;	// Receives the traces of lost games, if not nullptr
+	std::mutex		lossLock;	// Taken while writing to lossFile
+	bool		comparing;		// If true, the baseline plays every world too
+	AgentFactory	baseline;	// Makes the baseline's agents
+	double		confidence;		// Of the comparison
+
+	// Result Variables
+	int		numOfScores;
+	double	sumOfScores;
+	double	sumOfScoresSquared;
+	Comparison	comparison;
+};
+
+#endif /* TOURNAMENT_LOCK */
@@ -0,0 +1,162 @@
+// ======================================================================
+// FILE:        Trace.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the trace class, the record of one
+//              game that can be written, read and replayed.
+// ======================================================================
+
+#include "Trace.hpp"
+
+#include <cstring>
+#include <exception>
+#include "Rules.hpp"
+
+using namespace std;
+
+static const char MAGIC[8] = { 'W', 'W', 'T', 'R', 'A', 'C', '0', '1' };
+
+// A record holding more tiles or steps than this is taken as corrupt
+static const uint64_t MAX_LENGTH = 1 << 24;
+
+static uint64_t readUint ( const uint8_t *bytes, int size )
+{
+	uint64_t value = 0;
+	for ( int index = size-1; index >= 0; --index )
+		value = value << 8 | bytes[index];
+	return value;
+}
+
+static void writeUint ( uint64_t value, uint8_t *bytes, int size )
+{
+	for ( int index = 0; index < size; ++index )
+		bytes[index] = value >> ( 8*index );
+}
+
+// ===============================================================
+// =					Recording Functions
+// ===============================================================
+
+void Trace::start ( const GameState &state, uint64_t _seed )
+{
+	startState = state;
+	seed       = _seed;
+	score      = state.score;
+	steps.clear();
+}
+
+// ===============================================================
+// =					Replay Function
+// ===============================================================
+
+void Trace::seek ( GameState &state, size_t numOfSteps ) const
+{
+	state = startState;
+	if ( numOfSteps > steps.size() )
+		numOfSteps = steps.size();
+
+	for ( size_t step = 0; step < numOfSteps; ++step )
+	{
+		uint8_t percepts = state.stench()*STENCH | state.breeze()*BREEZE | state.glitter()*GLITTER
+		                 | state.bump*BUMP | state.scream*SCREAM;
+		if ( ( steps[step] & ~7 ) != percepts )
+			throw exception();
+
+		// Only the last step may end the game, as World::run ends it
+		bool over = Rules::step ( state, getAction ( step ) );
+		over = over || state.score < -1000;
+		if ( over != ( step+1 == steps.size() ) )
+			throw exception();
+	}
+
+	if ( numOfSteps == steps.size() && state.score != score )
+		throw exception();
+}
+
+// ===============================================================
+// =					File Functions
+// ===============================================================
+
+void Trace::writeHeader ( ostream &file )
+{
+	file.write ( MAGIC, sizeof(MAGIC) );
+	if ( file.fail() )
+		throw exception();
+}
+
+void Trace::readHeader ( istream &file )
+{
+	char magic[sizeof(MAGIC)];
+	file.read ( magic, sizeof(magic) );
+	if ( file.fail() || memcmp ( magic, MAGIC, sizeof(MAGIC) ) != 0 )
+		throw exception();
+}
+
+void Trace::write ( ostream &file ) const
+{
+	const GameState &state = startState;
+	uint8_t record[RECORD_SIZE];
+
+	writeUint ( seed, record, 8 );
+	writeUint ( (uint32_t)score, record + 8, 4 );
+	writeUint ( state.colDimension, record + 12, 4 );
+	writeUint ( state.rowDimension, record + 16, 4 );
+	writeUint ( (uint32_t)state.score, record + 20, 4 );
+	record[24] = state.goldLooted | state.hasArrow << 1 | state.bump << 2 | state.scream << 3;
+	record[25] = state.agentDir;
+	record[26] = 0;
+	record[27] = 0;
+	writeUint ( state.agentX, record + 28, 4 );
+	writeUint ( state.agentY, record + 32, 4 );
+	writeUint ( steps.size(), record + 36, 4 );
+
+	file.write ( (const char*)record, RECORD_SIZE );
+	file.write ( (const char*)state.board.data(), state.board.size() );
+	file.write ( (const char*)steps.data(), steps.size() );
+	if ( file.fail() )
+		throw exception();
+}
+
+bool Trace::read ( istream &file )
+{
+	uint8_t record[RECORD_SIZE];
+	file.read ( (char*)record, RECORD_SIZE );
+	if ( file.gcount() == 0 && file.eof() )
+		return false;
+	if ( file.fail() )
+		throw exception();
+
+	uint64_t cols     = readUint ( record + 12, 4 );
+	uint64_t rows     = readUint ( record + 16, 4 );
+	uint64_t numSteps = readUint ( record + 36, 4 );
+	if ( cols < 1 || rows < 1 || cols*rows > MAX_LENGTH || numSteps > MAX_LENGTH )
+		throw exception();
+
+	GameState &state = startState;
+	state.clear ( cols, rows );
+	seed             = readUint ( record, 8 );
+	score            = (int32_t)readUint ( record + 8, 4 );
+	state.score      = (int32_t)readUint ( record + 20, 4 );
+	state.goldLooted = record[24] & 1;
+	state.hasArrow   = record[24] & 2;
+	state.bump       = record[24] & 4;
+	state.scream     = record[24] & 8;
+	state.agentDir   = record[25];
+	state.agentX     = readUint ( record + 28, 4 );
+	state.agentY     = readUint ( record + 32, 4 );
+	if ( state.agentDir > 3 || state.agentX >= cols || state.agentY >= rows )
+		throw exception();
+
+	steps.resize ( numSteps );
+	file.read ( (char*)state.board.data(), state.board.size() );
+	file.read ( (char*)steps.data(), steps.size() );
+	if ( file.fail() )
+		throw exception();
+
+	// Actions 6 and 7 do not exist
+	for ( size_t step = 0; step < steps.size(); ++step )
+		if ( ( steps[step] & 7 ) > Agent::CLIMB )
+			throw exception();
+	return true;
+}
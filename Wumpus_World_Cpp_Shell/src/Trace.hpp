@@ -0,0 +1,108 @@
+// ======================================================================
+// FILE:        Trace.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the trace class, the record of one
+//              game: the GameState it started from, its seed, and every
+//              action with the percepts the agent chose it on. A World
+//              with a trace records into it as it runs, and a trace can
+//              be replayed without the agent, at full speed or up to any
+//              step, to look at a game long after it was played.
+//
+// NOTES:       - File layout, all integers little-endian. A trace file
+//                is a header followed by any number of records:
+//
+//                  Header, 8 bytes:
+//                      8 bytes  magic "WWTRAC01"
+//
+//                  Record, 40 bytes and one per tile and step:
+//                      8 bytes  seed
+//                      4 bytes  final score
+//                      4 bytes  colDimension, rowDimension each
+//                      4 bytes  score at the start
+//                      1 byte   goldLooted, hasArrow, bump, scream,
+//                               as bits 0 to 3
+//                      1 byte   agentDir
+//                      2 bytes  reserved, zero
+//                      4 bytes  agentX, agentY each
+//                      4 bytes  number of steps
+//                      1 byte   per tile, the TileFlags of the board,
+//                               column after column
+//                      1 byte   per step, the action as bits 0 to 2 and
+//                               stench, breeze, glitter, bump, scream
+//                               as bits 3 to 7
+//
+//              - Reading refuses a record whose board size, agent or
+//                any step's action is impossible.
+//
+//              - Replaying checks every percept against the recorded
+//                one, so a trace that no longer matches the Rules is
+//                reported instead of replayed wrongly.
+// ======================================================================
+
+#ifndef TRACE_LOCK
+#define TRACE_LOCK
+
+#include<cstddef>
+#include<cstdint>
+#include<istream>
+#include<ostream>
+#include<vector>
+#include"Agent.hpp"
+#include"GameState.hpp"
+
+class Trace
+{
+public:
+
+	static const size_t	HEADER_SIZE = 8;
+	static const size_t	RECORD_SIZE = 40;	// Without the tiles and steps
+
+	// Percept bits of a step, above the action
+	enum Percept
+	{
+		STENCH  = 1 << 3,
+		BREEZE  = 1 << 4,
+		GLITTER = 1 << 5,
+		BUMP    = 1 << 6,
+		SCREAM  = 1 << 7
+	};
+
+	Trace ( void ) : seed ( 0 ), score ( 0 ) {}
+
+	// Recording Functions, used by World::run
+	void	start	( const GameState &state, uint64_t seed );	// Forgets the last game, keeping the memory
+	void	record	( bool stench, bool breeze, bool glitter, bool bump, bool scream, Agent::Action action )
+	{
+		steps.push_back ( action | stench*STENCH | breeze*BREEZE | glitter*GLITTER | bump*BUMP | scream*SCREAM );
+	}
+	void	finish	( int _score ) { score = _score; }
+
+	// The recorded game
+	uint64_t			getSeed		( void ) const { return seed; }
+	int					getScore	( void ) const { return score; }
+	size_t				size		( void ) const { return steps.size(); }
+	const GameState&	getStart	( void ) const { return startState; }
+	Agent::Action		getAction	( size_t step ) const { return (Agent::Action)( steps[step] & 7 ); }
+
+	// Replays the first numOfSteps steps into state, all of them if there
+	// are fewer, throws std::exception if a percept differs from the
+	// recorded one, or the final score once every step is replayed
+	void	seek	( GameState &state, size_t numOfSteps ) const;
+
+	// File Functions, throw std::exception if the stream fails
+	static void	writeHeader	( std::ostream &file );
+	static void	readHeader	( std::istream &file );				// Also if it is not a trace file
+	void		write		( std::ostream &file ) const;
+	bool		read		( std::istream &file );				// False at the end of the file
+
+private:
+
+	GameState				startState;	// The game as the first step found it
+	uint64_t				seed;		// The game's seed
+	int						score;		// The final score
+	std::vector<uint8_t>	steps;		// One byte per action, with its percepts
+};
+
+#endif /* TRACE_LOCK */
@@ -10,83 +10,129 @@
 // ======================================================================
 
 #include "World.hpp"
+#include "FixedState.hpp"
+#include "SearchAI.hpp"
 
 using namespace std;
 
 // ===============================================================
-// =				Constructor and Destructor
+// =				Constructors and Destructor
 // ===============================================================	
 
-World::World ( bool _debug, bool _randomAI, bool _manualAI, string filename )
+World::World ( bool _debug, bool _randomAI, bool _manualAI, string filename, uint64_t seed, bool _searchAI )
 {
 	// Operation Flags
 	debug        = _debug;
 	manualAI     = _manualAI;
+	trace        = nullptr;
 	
-	// Agent Initialization
-	goldLooted   = false;
-	hasArrow     = true;
-	bump         = false;
-	scream       = false;
-	score        = 0;
-	agentDir     = 0;
-	agentX       = 0;
-	agentY       = 0;
-	lastAction   = Agent::CLIMB;
-	
-	if ( _randomAI )
-		agent = new RandomAI();
-	else if ( _manualAI )
-		agent = new ManualAI();
-	else
-		agent = new MyAI();
+	agent        = newAgent ( _randomAI, _manualAI, _searchAI );
+	ownsAgent    = true;
 	
 	// Board Initialization
 	if ( filename != "" )
 	{
-		ifstream file;
-		file.open(filename);
-		
-		file >> colDimension >> rowDimension;
-		if (file.fail())
-			throw exception();
-
-		board = new Tile*[colDimension];
-		for ( int index = 0; index < colDimension; ++index )
-			board[index] = new Tile[rowDimension];
-
-		addFeatures ( file );
-		file.close();
+		WorldSpec spec;
+		try
+		{
+			spec.read ( filename );
+		}
+		catch (...)
+		{
+			delete agent;
+			throw;
+		}
+		reset ( spec, seed );
 	}
 	else
 	{
-		colDimension = 4;
-		rowDimension = 4;
-		
-		board = new Tile*[colDimension];
-		for ( int index = 0; index < colDimension; ++index )
-			board[index] = new Tile[rowDimension];
-			
+		resetAgentState ( seed );
+		state.clear ( 4, 4 );
 		addFeatures ( );
 	}
 }
 
+World::World ( Agent* _agent, bool _debug, bool _manualAI )
+{
+	// Operation Flags
+	debug        = _debug;
+	manualAI     = _manualAI;
+	trace        = nullptr;
+	
+	agent        = _agent;
+	ownsAgent    = false;
+	
+	// Board Initialization, an empty GameState
+	resetAgentState ( 0 );
+}
+
 World::~World()
 {
-	for ( int index = 0; index < colDimension; ++index )
-		delete [] board[index];
+	if ( ownsAgent )
+		delete agent;
+}
+
+// ===============================================================
+// =				World Initialization Functions
+// ===============================================================
+
+Agent* World::newAgent ( bool randomAI, bool manualAI, bool searchAI )
+{
+	if ( randomAI )
+		return new RandomAI();
+	if ( manualAI )
+		return new ManualAI();
+	if ( searchAI )
+		return new SearchAI();
+	return new MyAI();
+}
+
+void World::reset ( const WorldSpec &spec, uint64_t seed )
+{
+	resetAgentState ( seed );
+	state.reset ( spec );
+}
+
+void World::resetAgentState ( uint64_t _seed )
+{
+	lastAction   = Agent::CLIMB;
+	seed         = _seed;
 	
-	delete [] board;
-	delete agent;
+	rng = Random ( Random::deriveSeed ( seed, 0 ) );
+	agent->reset ( Random::deriveSeed ( seed, 1 ) );
 }
 
 // ===============================================================
-// =					Engine Function
+// =					Engine Functions
 // ===============================================================	
 
+// Plays the game loop on any state, for the dispatch to fixed states
+struct World::Player
+{
+	World	&world;
+
+	template <typename State>
+	int operator() ( State &game ) { return world.play ( game ); }
+};
+
 int World::run ( void )
 {	
-	while ( score >= -1000 )
+	if ( trace )
+		trace->start ( state, seed );
+	
+	// Debug mode shows the GameState before every move, so it plays on it
+	Player player = { *this };
+	int score = ( debug || manualAI ) ? play ( state ) : playOnFixedState ( state, player );
+	
+	if ( trace )
+		trace->finish ( score );
+	return score;
+}
+
+template <typename State>
+int World::play ( State &game )
+{
+	while ( game.score >= -1000 )
 	{
 		if ( debug || manualAI )
 		{
@@ -102,118 +148,30 @@ int World::run ( void )
 		}
 		
 		// Get the move
+		bool stench  = game.stench();
+		bool breeze  = game.breeze();
+		bool glitter = game.glitter();
 		lastAction = agent->getAction
 		(
-			board[agentX][agentY].stench,
-			board[agentX][agentY].breeze,
-			board[agentX][agentY].gold,
-			bump,
-			scream
+			stench,
+			breeze,
+			glitter,
+			game.bump,
+			game.scream
 		);
+		
+		if ( trace )
+			trace->record ( stench, breeze, glitter, game.bump, game.scream, lastAction );
 
 		// Make the move
-		--score;
-		bump   = false;
-		scream = false;
-		
-		switch ( lastAction )
+		if ( Rules::step ( game, lastAction ) )
 		{
-			case Agent::TURN_LEFT:
-				if (--agentDir > 3) agentDir = 3;	// This works because size_t is unsigned
-				break;
-				
-			case Agent::TURN_RIGHT:
-				if (++agentDir > 3) agentDir = 0;
-				break;
-				
-			case Agent::FORWARD:
-				if ( agentDir == 0 && agentX+1 < colDimension )
-					++agentX;
-				else if ( agentDir == 1 && agentY-1 < rowDimension ) // This still works because size_t
-					--agentY;
-				else if ( agentDir == 2 && agentX-1 < colDimension ) // gets big, instead of going negative
-					--agentX;
-				else if ( agentDir == 3 && agentY+1 < rowDimension )
-					++agentY;
-				else
-					bump = true;
-				
-				if ( board[agentX][agentY].pit || board[agentX][agentY].wumpus )
-				{
-					score -= 1000;
-					if (debug) printWorldInfo();
-					return score;
-				}
-				break;
-			
-			case Agent::SHOOT:
-				if ( hasArrow )
-				{
-					hasArrow = false;
-					score -= 10;
-					if ( agentDir == 0 )
-					{
-						for ( size_t x = agentX; x < colDimension; ++x )
-							if ( board[x][agentY].wumpus )
-							{
-								board[x][agentY].wumpus = false;
-								board[x][agentY].stench = true;
-								scream = true;
-							}
-					}
-					else if ( agentDir == 1 )
-					{
-						for ( size_t y = agentY; y < rowDimension; --y )
-							if ( board[agentX][y].wumpus )
-							{
-								board[agentX][y].wumpus = false;
-								board[agentX][y].stench = true;
-								scream = true;
-							}
-					}
-					else if ( agentDir == 2 )
-					{
-						for ( size_t x = agentX; x < colDimension; --x )
-							if ( board[x][agentY].wumpus )
-							{
-								board[x][agentY].wumpus = false;
-								board[x][agentY].stench = true;
-								scream = true;
-							}
-					}
-					else if ( agentDir == 3 )
-					{
-						for ( size_t y = agentY; y < rowDimension; ++y )
-							if ( board[agentX][y].wumpus )
-							{
-								board[agentX][y].wumpus = false;
-								board[agentX][y].stench = true;
-								scream = true;
-							}
-					}
-				}
-				break;
-				
-			case Agent::GRAB:
-				if ( board[agentX][agentY].gold )
-				{
-					board[agentX][agentY].gold = false;
-					goldLooted = true;
-				}
-				break;
-				
-			case Agent::CLIMB:
-				if ( agentX == 0 && agentY == 0 )
-				{
-					if ( goldLooted )
-						score += 1000;
-					if (debug) printWorldInfo();
-					return score;
-				}
-				break;
+			if (debug) printWorldInfo();
+			break;
 		}
 	}
-	return score;
+	
+	return game.score;
 }
 
 // ===============================================================
@@ -223,115 +181,36 @@ int World::run ( void )
 void World::addFeatures ( void )
 {		
 	// Generate pits
-	for ( int r = 0; r < rowDimension; ++r )
-		for ( int c = 0; c < colDimension; ++c )
+	for ( int r = 0; r < state.rowDimension; ++r )
+		for ( int c = 0; c < state.colDimension; ++c )
 			if ( (c != 0 || r != 0) && randomInt(10) < 2 )
-				addPit ( c, r );
+				Rules::addPit ( state, c, r );
 	
 	// Generate wumpus
-	int wc = randomInt(colDimension);
-	int wr = randomInt(rowDimension);
+	int wc = randomInt(state.colDimension);
+	int wr = randomInt(state.rowDimension);
 	
 	while ( wc == 0 && wr == 0 )
 	{
-		wc = randomInt(colDimension);
-		wr = randomInt(rowDimension);
+		wc = randomInt(state.colDimension);
+		wr = randomInt(state.rowDimension);
 	}
 	
-	addWumpus ( wc, wr );
+	Rules::addWumpus ( state, wc, wr );
 	
 	// Generate gold
-	int gc = randomInt(colDimension);
-	int gr = randomInt(rowDimension);
+	int gc = randomInt(state.colDimension);
+	int gr = randomInt(state.rowDimension);
 		
 	while ( gc == 0 && gr == 0 )
 	{
-		gc = randomInt(colDimension);
-		gr = randomInt(rowDimension);
+		gc = randomInt(state.colDimension);
+		gr = randomInt(state.rowDimension);
 	}
 	
-	addGold ( gc, gr );
+	Rules::addGold ( state, gc, gr );
 }	
 
-void World::addFeatures ( ifstream &file )
-{
-	int c, r;
-	
-	// Add the Wumpus
-	file >> c >> r;
-	if (file.fail())
-		throw exception();
-	addWumpus ( c, r );
-	
-	// Add the Gold
-	file >> c >> r;
-	if (file.fail())
-		throw exception();
-	addGold ( c, r );
-	
-	// Add the Pits
-	int numOfPits;
-	file >> numOfPits;
-	if (file.fail())
-		throw exception();
-	
-	while ( numOfPits > 0 && !file.eof() )
-	{
-		--numOfPits;
-		file >> c >> r;
-		if (file.fail())
-			throw exception();
-		addPit ( c, r );
-	}
-}
-
-void World::addPit ( size_t c, size_t r )
-{
-	if ( isInBounds(c, r) )
-	{
-		board[c][r].pit = true;
-		addBreeze ( c+1, r );
-		addBreeze ( c-1, r );
-		addBreeze ( c, r+1 );
-		addBreeze ( c, r-1 );
-	}
-}
-
-void World::addWumpus ( size_t c, size_t r )
-{
-	if ( isInBounds(c, r) )
-	{
-		board[c][r].wumpus = true;
-		addStench ( c+1, r );
-		addStench ( c-1, r );
-		addStench ( c, r+1 );
-		addStench ( c, r-1 );
-	}
-}
-
-void World::addGold ( size_t c, size_t r )
-{
-	if ( isInBounds(c, r) )
-		board[c][r].gold = true;
-}
-
-void World::addStench ( size_t c, size_t r )
-{
-	if ( isInBounds(c, r) )
-		board[c][r].stench = true;
-}
-
-void World::addBreeze ( size_t c, size_t r )
-{
-	if ( isInBounds(c, r) )
-		board[c][r].breeze = true;
-}
-
-bool World::isInBounds ( size_t c, size_t r )
-{
-	return ( c < colDimension && r < rowDimension );
-}
-
 // ===============================================================
 // =				World Printing Functions
 // ===============================================================
@@ -344,9 +223,9 @@ void World::printWorldInfo ( void )
 
 void World::printBoardInfo ( void )
 {
-	for ( int r = rowDimension-1; r >= 0; --r )
+	for ( int r = state.rowDimension-1; r >= 0; --r )
 	{
-		for ( int c = 0; c < colDimension; ++c )
+		for ( int c = 0; c < state.colDimension; ++c )
 			printTileInfo ( c, r );
 		cout << endl << endl;
 	}
@@ -356,13 +235,15 @@ void World::printTileInfo ( size_t c, size_t r )
 {
 	string tileString = "";
 	
-	if (board[c][r].pit)    tileString.append("P");
-	if (board[c][r].wumpus) tileString.append("W");
-	if (board[c][r].gold)   tileString.append("G");
-	if (board[c][r].breeze) tileString.append("B");
-	if (board[c][r].stench) tileString.append("S");
+	uint8_t tile = state.tile ( c, r );
+	
+	if (tile & Rules::PIT)    tileString.append("P");
+	if (tile & Rules::WUMPUS) tileString.append("W");
+	if (tile & Rules::GOLD)   tileString.append("G");
+	if (tile & Rules::BREEZE) tileString.append("B");
+	if (tile & Rules::STENCH) tileString.append("S");
 	
-	if ( agentX == c && agentY == r )
+	if ( state.agentX == c && state.agentY == r )
 		tileString.append("@");
 	
 	tileString.append(".");
@@ -372,9 +253,9 @@ void World::printTileInfo ( size_t c, size_t r )
 
 void World::printAgentInfo ( void )
 {
-	cout << "Score: "       << score    << endl;
-	cout << "AgentX: "      << agentX   << endl;
-	cout << "AgentY: "      << agentY   << endl;
+	cout << "Score: "       << state.score    << endl;
+	cout << "AgentX: "      << state.agentX   << endl;
+	cout << "AgentY: "      << state.agentY   << endl;
 	printDirectionInfo();
 	printActionInfo();
 	printPerceptInfo();
@@ -382,7 +263,7 @@ void World::printAgentInfo ( void )
 
 void World::printDirectionInfo ( void )
 {
-	switch (agentDir)
+	switch (state.agentDir)
 	{
 		case 0:
 			cout << "AgentDir: Right" << endl;
@@ -442,11 +323,11 @@ void World::printPerceptInfo ( void )
 {
 	string perceptString = "Percepts: ";
 	
-	if (board[agentX][agentY].stench) perceptString.append("Stench, ");
-	if (board[agentX][agentY].breeze) perceptString.append("Breeze, ");
-	if (board[agentX][agentY].gold)   perceptString.append("Glitter, ");
-	if (bump)                         perceptString.append("Bump, ");
-	if (scream)                       perceptString.append("Scream");
+	if (state.stench())               perceptString.append("Stench, ");
+	if (state.breeze())               perceptString.append("Breeze, ");
+	if (state.glitter())              perceptString.append("Glitter, ");
+	if (state.bump)                   perceptString.append("Bump, ");
+	if (state.scream)                 perceptString.append("Scream");
 	
 	if ( perceptString[perceptString.size()-1] == ' '
 			&& perceptString[perceptString.size()-2] == ',' )
@@ -464,5 +345,5 @@ void World::printPerceptInfo ( void )
 
 int World::randomInt ( int limit )
 {
-	return rand() % limit;
+	return rng.randomInt ( limit );
 }
\ No newline at end of file
@@ -18,69 +18,83 @@
 #include<fstream>
 #include<cstdlib>
 #include<exception>
+#include<cstdint>
+#include<vector>
 #include"Agent.hpp"
 #include"ManualAI.hpp"
 #include"RandomAI.hpp"
 #include"MyAI.hpp"
+#include"Random.hpp"
+#include"WorldSpec.hpp"
+#include"Rules.hpp"
+#include"GameState.hpp"
+#include"Trace.hpp"
 
 class World
 {
 public:
 
-	// Constructor
-	World ( bool debug = false, bool randomAI = false, bool manualAI = false, std::string filename = "" );
+	// Constructors
+	World ( bool debug = false, bool randomAI = false, bool manualAI = false, std::string filename = "", uint64_t seed = 0, bool searchAI = false );
+	World ( Agent* agent, bool debug = false, bool manualAI = false );	// Borrows agent, board is empty until reset
 	
 	// Destructor
 	~World();
 	
+	// A World owns or borrows its agent, copy its GameState instead
+	World ( const World& ) = delete;
+	World& operator= ( const World& ) = delete;
+	
+	// Creates the agent selected by the command line flags, owned by the caller
+	static Agent*	newAgent	( bool randomAI = false, bool manualAI = false, bool searchAI = false );
+	
+	// Starts a new game on spec, reusing the board memory and the agent
+	void	reset	( const WorldSpec &spec, uint64_t seed = 0 );
+	
 	// Engine Function
 	int	run	( void );
 	
-private:
-	// Tile Structure
-	struct Tile
-	{
-		bool pit    = false;
-		bool wumpus = false;
-		bool gold   = false;
-		bool breeze = false;
-		bool stench = false;
-	};
+	// The game as it stands, a snapshot is a copy of it
+	const GameState&	getState	( void ) const { return state; }
+	
+	// Continues the game from a snapshot, the agent keeps what it knows
+	void	restore	( const GameState &snapshot, Agent::Action last = Agent::CLIMB ) { state = snapshot; lastAction = last; }
+	
+	// Records every game run from now on into trace, or none if nullptr
+	void	setTrace	( Trace *_trace ) { trace = _trace; }
 	
+	// Displays the board and the agent, as debug mode does before every move
+	void	printWorldInfo		( void );
+	
+private:
 	// Operation Variables
 	bool 	debug;			// If true, displays board info after every move
 	bool	manualAI;		// If true, alters the behavior of debug for flow purposes
+	Random	rng;			// Generates the random board, seeded per World
+	uint64_t	seed;		// The game's seed
+	Trace*	trace;			// Records the games run, if not nullptr
 	
 	// Agent Variables
 	Agent* 	agent;			// The agent
-	int 	score;			// The agent's score
-	bool	goldLooted;		// True if gold was successfuly looted
-	bool	hasArrow;		// True if the agent can shoot
-	bool	bump;			// Bump percept flag
-	bool	scream;			// Scream percept flag
-	size_t	agentDir;		// The direction the agent is facing: 0 - right, 1 - down, 2 - left, 3 - up
-	size_t	agentX;			// The column where the agent is located ( x-coord = col-coord )
-	size_t	agentY;			// The row where the agent is located ( y-coord = row-coord )
+	bool	ownsAgent;		// True if the agent is deleted with the World
 
 	Agent::Action	lastAction;	// The last action the agent made
 	
-	// Board Variables
-	size_t	colDimension;	// The number of columns the game board has
-	size_t	rowDimension;	// The number of rows the game board has
-	Tile**	board;			// The game board
+	// Game Variables
+	GameState	state;		// The board and the agent's position, arrow and score
+	
+	// Engine Functions
+	struct Player;
+	template <typename State>
+	int		play	( State &game );			// The game loop, on state or a FixedState of its size
+	
+	// World Initialization Functions
+	void	resetAgentState	( uint64_t seed );					// Reseeds the World and the agent for a new game
 	
 	// World Generation Functions
 	void 	addFeatures	( void );					// Populates the board with random features
-	void	addFeatures ( std::ifstream &file );	// Populates the board with features specified in file
-	void 	addPit 		( size_t c, size_t r );
-	void 	addWumpus	( size_t c, size_t r );
-	void 	addGold		( size_t c, size_t r );
-	void 	addStench	( size_t c, size_t r );
-	void 	addBreeze	( size_t c, size_t r );
-	bool 	isInBounds	( size_t c, size_t r );
 	
 	// World Printing Functions
-	void	printWorldInfo		( void );
 	void	printBoardInfo		( void );
 	void	printTileInfo		( size_t c, size_t r );
 	void	printAgentInfo		( void );
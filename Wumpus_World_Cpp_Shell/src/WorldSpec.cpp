@@ -0,0 +1,84 @@
+// ======================================================================
+// FILE:        WorldSpec.cpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the world specification reader and
+//              the random world generation.
+// ======================================================================
+
+#include "WorldSpec.hpp"
+
+#include <fstream>
+#include <exception>
+
+using namespace std;
+
+void WorldSpec::read ( istream &file )
+{
+	file >> colDimension >> rowDimension;
+	if ( file.fail() || colDimension < 1 || rowDimension < 1 )
+		throw exception();
+
+	// The Wumpus
+	file >> wumpusC >> wumpusR;
+	if ( file.fail() )
+		throw exception();
+
+	// The Gold
+	file >> goldC >> goldR;
+	if ( file.fail() )
+		throw exception();
+
+	// The Pits
+	int numOfPits;
+	file >> numOfPits;
+	if ( file.fail() )
+		throw exception();
+
+	pits.clear();
+	while ( numOfPits > 0 && !file.eof() )
+	{
+		--numOfPits;
+		int c, r;
+		file >> c >> r;
+		if ( file.fail() )
+			throw exception();
+		pits.push_back ( make_pair ( c, r ) );
+	}
+}
+
+void WorldSpec::read ( const string &filename )
+{
+	ifstream file;
+	file.open ( filename );
+	read ( file );
+	file.close();
+}
+
+void WorldSpec::generate ( Random &rng, int cols, int rows )
+{
+	colDimension = cols;
+	rowDimension = rows;
+
+	// Same draw order as the World's own random boards
+	pits.clear();
+	for ( int r = 0; r < rows; ++r )
+		for ( int c = 0; c < cols; ++c )
+			if ( ( c != 0 || r != 0 ) && rng.randomInt ( 10 ) < 2 )
+				pits.push_back ( make_pair ( c, r ) );
+
+	do
+	{
+		wumpusC = rng.randomInt ( cols );
+		wumpusR = rng.randomInt ( rows );
+	}
+	while ( wumpusC == 0 && wumpusR == 0 );
+
+	do
+	{
+		goldC = rng.randomInt ( cols );
+		goldR = rng.randomInt ( rows );
+	}
+	while ( goldC == 0 && goldR == 0 );
+}
@@ -0,0 +1,46 @@
+// ======================================================================
+// FILE:        WorldSpec.hpp
+//
+// AUTHOR:      Lei Pan
+//
+// DESCRIPTION: This file contains the world specification, a plain
+//              description of a board (dimensions, wumpus, gold and
+//              pits) that a World can be reset to. A spec can be read
+//              from a world file, generated at random, or filled in
+//              directly by a caller that keeps its worlds in memory.
+//
+// NOTES:       - Coordinates are (column, row), as in the world files.
+//                Features outside the board are ignored by the World.
+// ======================================================================
+
+#ifndef WORLDSPEC_LOCK
+#define WORLDSPEC_LOCK
+
+#include<string>
+#include<vector>
+#include<utility>
+#include<istream>
+#include"Random.hpp"
+
+struct WorldSpec
+{
+	int		colDimension = 0;	// The number of columns the game board has
+	int		rowDimension = 0;	// The number of rows the game board has
+	int		wumpusC      = 0;
+	int		wumpusR      = 0;
+	int		goldC        = 0;
+	int		goldR        = 0;
+
+	std::vector<std::pair<int, int>> pits;	// (column, row) of every pit
+
+	// Reads a spec in the world file format, throws std::exception if malformed
+	void	read	( std::istream &file );
+	void	read	( const std::string &filename );
+
+	// Fills in a random board with the distribution of the world generator:
+	// every tile but (0,0) is a pit with probability 0.2, and the wumpus
+	// and the gold are placed anywhere but (0,0)
+	void	generate	( Random &rng, int cols, int rows );
+};
+
+#endif /* WORLDSPEC_LOCK */
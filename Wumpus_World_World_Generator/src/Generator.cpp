@@ -3,106 +3,285 @@
 //
 // AUTHOR:      Abdullah Younis
 //
-// DESCRIPTION: This file contains the Wumpus World Generator script. 
+// DESCRIPTION: This file contains the Wumpus World Generator script.
+//
+// NOTES:       - Usage:
+//
+//                  World_Generator [Options] Base_File_Name #ofWorlds rowDim colDim [seed]
+//
+//                  Options:
+//                      -jN generates the worlds on N threads, or on one
+//                          thread per core if N is omitted.
+//                      -q  Quiet mode, does not print every world.
+//                      -p  writes every world into the single corpus
+//                          file Base_File_Name.bin, in the packed format
+//                          of the C++ shell's Corpus.hpp, instead of one
+//                          text file per world. Boards must be at most
+//                          8x8.
+//
+//                Without a seed the current time is used. World number
+//                i is generated from seed+i alone, so the same seed
+//                always generates the same set of worlds, for any number
+//                of threads, and any single world can be regenerated.
 // ======================================================================
 
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <cctype>
 #include <ctime>
 #include <sstream>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
-// Randomly generate a int between 0 and limit-1
-int randomInt ( int limit )
+// Generator state, SplitMix64 as in the C++ shell's Random.hpp
+struct Random
+{
+	uint64_t state;
+
+	Random ( uint64_t seed ) : state ( seed ) {}
+
+	// Randomly generate a int between 0 and limit-1
+	int randomInt ( int limit )
+	{
+		uint64_t z = ( state += 0x9E3779B97F4A7C15ULL );
+		z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+		z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+		return (int)( ( z ^ ( z >> 31 ) ) % (uint64_t)limit );
+	}
+};
+
+// One generated world, as it is written to the world file
+struct GenWorld
 {
-	return rand()%limit;
+	int wc, wr;
+	int gc, gr;
+	vector<pair<int, int>> pits;	// Written in this order, reused between worlds
+};
+
+// Packed corpus format, must match the C++ shell's Corpus.hpp
+const char		CORPUS_MAGIC[8]     = { 'W', 'W', 'C', 'O', 'R', 'P', '0', '1' };
+const size_t	CORPUS_HEADER_SIZE  = 16;
+const size_t	CORPUS_RECORD_SIZE  = 16;
+const int		CORPUS_MAX_DIMENSION = 8;
+
+void writeUint64 ( uint64_t value, uint8_t *bytes )
+{
+	for ( int index = 0; index < 8; ++index )
+		bytes[index] = value >> ( 8*index );
 }
-	
-void genWorld ( int colDimension, int rowDimension, string filename )
+
+void genWorld ( int colDimension, int rowDimension, uint64_t seed, GenWorld &world )
 {
-	int wc, wr = 0;
-	int gc, gr = 0;
-	int numPits = 0;
-	int pitx[256];
-	int pity[256];
-		
+	Random rng ( seed );
+
 	// Generate pits
+	world.pits.clear();
 	for ( int r = 0; r < rowDimension; ++r )
 		for ( int c = 0; c < colDimension; ++c )
-			if ( (c != 0 || r != 0) && randomInt(10) < 2 )
-			{
-				pitx[numPits] = r;
-				pity[numPits++] = c;
-			}
-		
+			if ( (c != 0 || r != 0) && rng.randomInt(10) < 2 )
+				world.pits.push_back ( make_pair ( r, c ) );
+
 	// Generate wumpus and gold
-	wc = randomInt(colDimension);
-	wr = randomInt(rowDimension);
-	gc = randomInt(colDimension);
-	gr = randomInt(rowDimension);
-		
-	while ( wc == 0 && wr == 0 )
+	world.wc = rng.randomInt(colDimension);
+	world.wr = rng.randomInt(rowDimension);
+	world.gc = rng.randomInt(colDimension);
+	world.gr = rng.randomInt(rowDimension);
+
+	while ( world.wc == 0 && world.wr == 0 )
 	{
-		wc = randomInt(colDimension);
-		wr = randomInt(rowDimension);
+		world.wc = rng.randomInt(colDimension);
+		world.wr = rng.randomInt(rowDimension);
 	}
-		
-	while ( gc == 0 && gr == 0 )
+
+	while ( world.gc == 0 && world.gr == 0 )
 	{
-		gc = randomInt(colDimension);
-		gr = randomInt(rowDimension);
+		world.gc = rng.randomInt(colDimension);
+		world.gr = rng.randomInt(rowDimension);
 	}
-	
+}
+
+void writeWorld ( int colDimension, int rowDimension, const GenWorld &world, string filename )
+{
+	// Build the file in memory and write it at once
+	stringstream ss;
+	ss << colDimension << '\t' << rowDimension;
+	ss << "\r\n" << world.wc << '\t' << world.wr;
+	ss << "\r\n" << world.gc << '\t' << world.gr;
+	ss << "\r\n" << world.pits.size();
+	for ( size_t i = 0; i < world.pits.size(); ++i )
+		ss << "\r\n" << world.pits[i].first << '\t' << world.pits[i].second;
+
 	ofstream file;
-	file.open( filename );
-	
-	file << colDimension << '\t' << rowDimension;
-	file << "\r\n" << wc << '\t' << wr;
-	file << "\r\n" << gc << '\t' << gr;
-	file << "\r\n" << numPits;
-	for ( int i = 0; i < numPits; ++i )
-		file << "\r\n" << pitx[i] << '\t' << pity[i];
-	
+	file.open( filename, ios::binary );
+	file << ss.rdbuf();
 	file.close();
 }
-	
+
+// Encodes a world into a corpus record, pits are read as the world file reads them.
+// A pit read off the board is ignored by the World, so it is dropped, as the
+// shell's Corpus::encode does
+void packWorld ( int colDimension, int rowDimension, const GenWorld &world, uint8_t *record )
+{
+	record[0] = colDimension;
+	record[1] = rowDimension;
+	record[2] = world.wc;
+	record[3] = world.wr;
+	record[4] = world.gc;
+	record[5] = world.gr;
+	record[6] = 0;
+	record[7] = 0;
+
+	uint64_t pits = 0;
+	for ( size_t i = 0; i < world.pits.size(); ++i )
+	{
+		int c = world.pits[i].first;
+		int r = world.pits[i].second;
+		if ( c >= colDimension || r >= rowDimension )
+			continue;
+		pits |= 1ULL << ( r*CORPUS_MAX_DIMENSION + c );
+	}
+	writeUint64 ( pits, record + 8 );
+}
+
+void printUsage ( void )
+{
+	cout << "Usage: World_Generator [-jN] [-q] [-p] Base_File_Name #ofWorlds rowDim colDim [seed]" << endl;
+}
+
 int main ( int argc, char *argv[] )
 {
 	string baseFileName;
 	int numOfFiles;
 	int rowDimension;
 	int colDimension;
-	
-	if ( argc == 5 )
+	uint64_t seed = time(NULL);
+	unsigned numOfThreads = 1;
+	bool quiet = false;
+	bool packed = false;
+
+	// Parse Options
+	int first = 1;
+	if ( argc > 1 && argv[1][0] == '-' )
 	{
-		try
-		{
-			baseFileName = argv[1];
-			numOfFiles = atoi(argv[2]);
-			colDimension = atoi(argv[3]);
-			rowDimension = atoi(argv[4]);
-		}
-		catch ( const std::exception& e )
+		string options = argv[1];
+		for ( size_t index = 1; index < options.size(); ++index )
 		{
-			cout << "Usage: World_Generator Base_File_Name #ofWorlds rowDim colDim" << endl;
-			return 0;
+			switch ( tolower ( options[index] ) )
+			{
+				case 'j':
+					numOfThreads = 0;
+					while ( index+1 < options.size() && isdigit ( options[index+1] ) )
+						numOfThreads = numOfThreads*10 + ( options[++index] - '0' );
+					if ( numOfThreads == 0 )
+						numOfThreads = thread::hardware_concurrency();
+					if ( numOfThreads == 0 )
+						numOfThreads = 1;
+					break;
+
+				case 'q':
+					quiet = true;
+					break;
+
+				case 'p':
+					packed = true;
+					break;
+
+				default:
+					printUsage();
+					return 0;
+			}
 		}
+		first = 2;
+	}
+
+	if ( argc - first == 4 || argc - first == 5 )
+	{
+		baseFileName = argv[first];
+		numOfFiles = atoi(argv[first+1]);
+		colDimension = atoi(argv[first+2]);
+		rowDimension = atoi(argv[first+3]);
+		if ( argc - first == 5 )
+			seed = strtoull(argv[first+4], NULL, 10);
 	}
 	else
 	{
-		cout << "Usage: World_Generator Base_File_Name #ofWorlds rowDim colDim" << endl;
+		printUsage();
+		return 0;
+	}
+
+	if ( numOfFiles < 0 || colDimension < 1 || rowDimension < 1 )
+	{
+		printUsage();
+		return 0;
+	}
+
+	if ( packed && ( colDimension > CORPUS_MAX_DIMENSION || rowDimension > CORPUS_MAX_DIMENSION ) )
+	{
+		cout << "[ERROR] Packed worlds are at most " << CORPUS_MAX_DIMENSION << "x" << CORPUS_MAX_DIMENSION << "." << endl;
 		return 0;
 	}
 
-	srand( time(NULL) );	// Set random seed
-	for (int i = 0; i < numOfFiles; ++i )
+	vector<uint8_t> corpus;
+	if ( packed )
 	{
-		cout << "Creating world number: " << i << "." << endl;
-		stringstream ss;
-		ss << baseFileName << "_" << i << ".txt";
-		genWorld( colDimension, rowDimension, ss.str() );
+		corpus.resize ( CORPUS_HEADER_SIZE + numOfFiles*CORPUS_RECORD_SIZE );
+		memcpy ( corpus.data(), CORPUS_MAGIC, sizeof(CORPUS_MAGIC) );
+		writeUint64 ( numOfFiles, corpus.data() + sizeof(CORPUS_MAGIC) );
+	}
+
+	// Every thread generates its own contiguous range of worlds
+	mutex outputLock;
+	auto generate = [&] ( unsigned threadIndex )
+	{
+		int begin = (int)( (int64_t)numOfFiles * threadIndex / numOfThreads );
+		int end   = (int)( (int64_t)numOfFiles * ( threadIndex+1 ) / numOfThreads );
+
+		GenWorld world;
+		for ( int i = begin; i < end; ++i )
+		{
+			if ( !quiet )
+			{
+				lock_guard<mutex> guard ( outputLock );
+				cout << "Creating world number: " << i << "." << endl;
+			}
+
+			genWorld ( colDimension, rowDimension, seed + i, world );
+			if ( packed )
+				packWorld ( colDimension, rowDimension, world, corpus.data() + CORPUS_HEADER_SIZE + i*CORPUS_RECORD_SIZE );
+			else
+			{
+				stringstream ss;
+				ss << baseFileName << "_" << i << ".txt";
+				writeWorld ( colDimension, rowDimension, world, ss.str() );
+			}
+		}
+	};
+
+	vector<thread> threads;
+	for ( unsigned threadIndex = 1; threadIndex < numOfThreads; ++threadIndex )
+		threads.push_back ( thread ( generate, threadIndex ) );
+	generate ( 0 );
+	for ( thread &t : threads )
+		t.join();
+
+	if ( packed )
+	{
+		ofstream file ( baseFileName + ".bin", ios::binary );
+		file.write ( (const char*)corpus.data(), corpus.size() );
+		file.close();
+		if ( file.fail() )
+		{
+			cout << "[ERROR] Failure to write " << baseFileName << ".bin." << endl;
+			return 0;
+		}
 	}
 	return 0;
-}
\ No newline at end of file
+}